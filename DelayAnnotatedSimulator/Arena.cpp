@@ -0,0 +1,58 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+
+Arena::~Arena() {
+    for(size_t i = 0; i < blocks.size(); i++) {
+        free(blocks[i]);
+    }
+}
+
+void * Arena::allocate(size_t bytes, size_t align) {
+    size_t padding = (align - (reinterpret_cast<uintptr_t>(current) % align)) % align;
+    if(current == NULL || padding + bytes > remaining) {
+        //oversized requests get a block of their own so the current block keeps its space
+        size_t size = std::max(block_size, bytes + align);
+        char * block = static_cast<char *>(malloc(size));
+        if(block == NULL) {
+            throw std::bad_alloc();
+        }
+        blocks.push_back(block);
+        if(bytes + align > block_size && current != NULL) {
+            allocated += bytes;
+            return block + (align - (reinterpret_cast<uintptr_t>(block) % align)) % align;
+        }
+        current = block;
+        remaining = size;
+        padding = (align - (reinterpret_cast<uintptr_t>(current) % align)) % align;
+    }
+    char * ptr = current + padding;
+    current += padding + bytes;
+    remaining -= padding + bytes;
+    allocated += bytes;
+    return ptr;
+}
@@ -0,0 +1,99 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef DelayAnnotatedSimulator_Arena_h
+#define DelayAnnotatedSimulator_Arena_h
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <type_traits>
+
+#define ARENA_BLOCK_SIZE (1 << 20)
+
+//Bump allocator. Memory is handed out from large blocks and only given back when the arena is
+//destroyed, so a Circuit's gates, adjacency and GIC bitmaps cost no per object malloc/free.
+//Objects placed in the arena still need their destructors run by the owner.
+class Arena {
+private:
+    std::vector<char *> blocks;
+    char * current;
+    size_t remaining;
+    size_t block_size;
+    size_t allocated;
+
+    Arena(const Arena&);
+    Arena& operator= (const Arena&);
+public:
+    Arena(size_t block_size = ARENA_BLOCK_SIZE) : current(NULL), remaining(0), block_size(block_size), allocated(0) {}
+    ~Arena();
+
+    void * allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    inline size_t bytesAllocated() const {
+        return allocated;
+    }
+};
+
+//std allocator drawing from an Arena, or from the heap when no arena is given so the same
+//containers still work for gates built outside a Circuit. deallocate is a no-op for arena memory.
+template <class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    Arena * arena;
+
+    ArenaAllocator(Arena * arena = NULL) : arena(arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T * allocate(size_t n) {
+        if(arena) {
+            return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T * ptr, size_t) {
+        if(!arena) {
+            ::operator delete(ptr);
+        }
+    }
+};
+
+template <class T, class U>
+inline bool operator== (const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+    return lhs.arena == rhs.arena;
+}
+
+template <class T, class U>
+inline bool operator!= (const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+    return lhs.arena != rhs.arena;
+}
+
+#endif
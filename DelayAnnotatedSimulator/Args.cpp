@@ -23,6 +23,9 @@
  */
 
 #include "Args.h"
+#include "FaultGroup.h"
+#include <thread>
+#include <algorithm>
 
 void Args::readArgs(int argc, const char * argv[] ) {
     if(argc == 1) {
@@ -32,16 +35,47 @@ void Args::readArgs(int argc, const char * argv[] ) {
                   << "                   defaults to stdin" << std::endl
                   << "       -fsim      : flag for fault simulation"  << std::endl
                   << "                   defaults to logic simulation" << std::endl
-                  << "       -dly       : reads gate delays from <ckt_name.dly>" << std::endl
+                  << "       -dly       : delay simulation, gate type delays from <ckt_name>.dly and per instance" << std::endl
+                  << "                   rise/fall delays from <ckt_name>.idly" << std::endl
+                  << "       -dmodel <transport|inertial> : delay model, defaults to transport, implies -dly" << std::endl
+                  << "       -cap       : gate capacitances from <ckt_name>.cap, implies -dly" << std::endl
+                  << "       -act       : switching activity to <ckt_name>_act.csv (by gate) and" << std::endl
+                  << "                   <ckt_name>_cycle_act.csv (by cycle), implies -dly" << std::endl
+                  << "       -power <vdd> <freq> : print the average dynamic power, requires -cap" << std::endl
                   << "       -wpo       : output POs" << std::endl
                   << "       -wstate    : output flip flops" << std::endl
-		  << "       -grp <num> : GIC FF group size" << std::endl;
+                  << "       -par       : pattern parallel logic simulation (64/256/512 wide), no GIC/toggle" << std::endl
+                  << "       -ppsfp     : full scan fault simulation of <ckt_name>.eqf, 64 patterns per pass" << std::endl
+                  << "       -comp      : compiled code logic simulation, builds a temporary <ckt_name>_sim.so, no GIC/toggle" << std::endl
+		  << "       -grp <num> : GIC FF group size" << std::endl
+                  << "       -engine <auto|event|sweep> : logic simulation engine, defaults to auto" << std::endl
+                  << "       -fgrp <64|128|256> : faults simulated per faulty machine pass, defaults to 64" << std::endl
+                  << "       -fthr <num> : fault simulation threads, 0 for one per core, defaults to 1" << std::endl
+                  << "       -simplify  : remove buffers, tie constants and inverters at load, GIC/toggle over the simplified netlist," << std::endl
+                  << "                   not with -dly (the removed cells' delays would be lost)" << std::endl;
         exit(-1);
     }
     //set defaults
     simulator_type = 0; //logic simulator
     input_source = &std::cin;
     output_source = &std::cout;
+    grouping_size = 5;
+    outputState = false;
+    outputPO = false;
+    delay = false;
+    delay_model = 0; //transport
+    capacitance = false;
+    outputActivity = false;
+    power = false;
+    vdd = 0.0;
+    freq = 0.0;
+    parallelPattern = false;
+    ppsfp = false;
+    compiled = false;
+    simplify = false;
+    logic_engine = 0; //switch on activity
+    fault_group_width = FAULT_GROUP_WIDTH_DEFAULT;
+    fault_threads = 1;
     bool from_file=false;
     for(int i = 1; i < argc; i++) {
         std::string arg(argv[i]);
@@ -56,11 +90,72 @@ void Args::readArgs(int argc, const char * argv[] ) {
         } else if(arg.compare("-fsim") == 0) {
             simulator_type = 1;
         } else if(arg.compare("-dly") == 0) {
-            simulator_type += 1;
+            delay = true;
+        } else if(arg.compare("-dmodel") == 0) {
+            std::string model((i + 1 < argc) ? argv[++i] : "");
+            if(model.compare("transport") == 0) {
+                delay_model = 0;
+            } else if(model.compare("inertial") == 0) {
+                delay_model = 1;
+            } else {
+                std::cerr << "ERROR: Invalid usage -dmodel <transport|inertial>" << std::endl;
+                exit(-10);
+            }
+            delay = true;
+        } else if(arg.compare("-cap") == 0) {
+            capacitance = true;
+            delay = true;
+        } else if(arg.compare("-act") == 0) {
+            outputActivity = true;
+            delay = true;
+        } else if(arg.compare("-power") == 0) {
+            std::stringstream vdd_ss((i + 1 < argc) ? argv[++i] : "");
+            std::stringstream freq_ss((i + 1 < argc) ? argv[++i] : "");
+            if(!(vdd_ss >> vdd) || !(freq_ss >> freq) || vdd <= 0.0 || freq <= 0.0) {
+                std::cerr << "ERROR: Invalid usage -power <vdd> <freq>" << std::endl;
+                exit(-10);
+            }
+            power = true;
+            delay = true;
         } else if(arg.compare("-wpo") == 0) {
             outputPO = true;
         } else if(arg.compare("-wstate") == 0) {
             outputState = true;
+        } else if(arg.compare("-par") == 0) {
+            parallelPattern = true;
+        } else if(arg.compare("-ppsfp") == 0) {
+            ppsfp = true;
+        } else if(arg.compare("-comp") == 0) {
+            compiled = true;
+        } else if(arg.compare("-simplify") == 0) {
+            simplify = true;
+        } else if(arg.compare("-engine") == 0) {
+            std::string engine((i + 1 < argc) ? argv[++i] : "");
+            if(engine.compare("auto") == 0) {
+                logic_engine = 0;
+            } else if(engine.compare("event") == 0) {
+                logic_engine = 1;
+            } else if(engine.compare("sweep") == 0) {
+                logic_engine = 2;
+            } else {
+                std::cerr << "ERROR: Invalid usage -engine <auto|event|sweep>" << std::endl;
+                exit(-10);
+            }
+        } else if(arg.compare("-fgrp") == 0) {
+            std::stringstream ss((i + 1 < argc) ? argv[++i] : "");
+            if(!(ss >> fault_group_width) || fault_group_width == 0 || fault_group_width % 64 != 0) {
+                std::cerr << "ERROR: Invalid usage -fgrp <64|128|256>" << std::endl;
+                exit(-10);
+            }
+        } else if(arg.compare("-fthr") == 0) {
+            std::stringstream ss((i + 1 < argc) ? argv[++i] : "");
+            if(!(ss >> fault_threads)) {
+                std::cerr << "ERROR: Invalid usage -fthr <num>" << std::endl;
+                exit(-10);
+            }
+            if(fault_threads == 0) {
+                fault_threads = std::max(std::thread::hardware_concurrency(), 1u);
+            }
         } else if(arg.compare("-grp") == 0) {
             std::stringstream ss(argv[++i]);
             ss >> grouping_size;
@@ -71,6 +166,15 @@ void Args::readArgs(int argc, const char * argv[] ) {
         }
     }
 
+    if(simplify && delay) {
+        std::cerr << "ERROR: Invalid usage -simplify cannot be combined with -dly/-dmodel/-cap/-act/-power" << std::endl;
+        exit(-10);
+    }
+    if(power && !capacitance) {
+        std::cerr << "ERROR: Invalid usage -power <vdd> <freq> requires -cap" << std::endl;
+        exit(-10);
+    }
+
     if(from_file) {
         if(circuit.empty()) {
             exit(-1);
@@ -41,6 +41,20 @@ private:
     unsigned int grouping_size;
     bool outputState;
     bool outputPO;
+    bool delay;
+    unsigned int delay_model; //LogicDelaySimulator::DelayModel
+    bool capacitance;
+    bool outputActivity;
+    bool power;
+    double vdd;
+    double freq;
+    bool parallelPattern;
+    bool ppsfp;
+    bool compiled;
+    bool simplify;
+    unsigned int logic_engine; //LogicSimulator::Engine
+    unsigned int fault_group_width;
+    unsigned int fault_threads;
 public:
     //getter/setters
     inline void setCircuitName(std::string name) {
@@ -73,6 +87,48 @@ public:
     inline bool isOutputPO() const {
         return outputPO;
     }
+    inline bool isDelay() const {
+        return delay;
+    }
+    inline unsigned int getDelayModel() const {
+        return delay_model;
+    }
+    inline bool isCapacitance() const {
+        return capacitance;
+    }
+    inline bool isOutputActivity() const {
+        return outputActivity;
+    }
+    inline bool isPower() const {
+        return power;
+    }
+    inline double getVdd() const {
+        return vdd;
+    }
+    inline double getFreq() const {
+        return freq;
+    }
+    inline bool isParallelPattern() const {
+        return parallelPattern;
+    }
+    inline bool isPPSFP() const {
+        return ppsfp;
+    }
+    inline bool isCompiled() const {
+        return compiled;
+    }
+    inline bool isSimplify() const {
+        return simplify;
+    }
+    inline unsigned int getLogicEngine() const {
+        return logic_engine;
+    }
+    inline unsigned int getFaultGroupWidth() const {
+        return fault_group_width;
+    }
+    inline unsigned int getFaultThreads() const {
+        return fault_threads;
+    }
 
     void readArgs(int argc, const char* argv[]);
 };
@@ -23,6 +23,9 @@
  */
 
 #include "Circuit.h"
+#include "FlatNetlist.h"
+#include "GateKernels.h"
+#include <algorithm>
 
 void Circuit::readLev(std::string filename, bool delay) {
     std::fstream circuit_desc(filename.c_str(), std::fstream::in);
@@ -62,31 +65,40 @@ void Circuit::readLev(std::string filename, bool delay) {
                 gate_info >> tmp;
                 fanin_ids.push_back(tmp);
             }
+            //fanins are listed twice, the fanout count is only used to size the fanout list
+            unsigned int num_fanout = 0;
+            for(unsigned int j = 0; j < num_fanin; j++) {
+                unsigned int tmp;
+                gate_info >> tmp;
+            }
+            if(!(gate_info >> num_fanout)) {
+                num_fanout = 0;
+            }
             //ignore rest of the fields (including fan out, fan in linking handles this
             Gate * created_gate;
             switch (type) {
             case 1: //INPUT
-                created_gate = new InputGate(id, level);
+                created_gate = newGate<InputGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 inputs.push_back(created_gate);
                 break;
             case 2: //OUTPUT
-                created_gate = new OutputGate(id, level);
+                created_gate = newGate<OutputGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 outputs.push_back(created_gate);
                 break;
             case 3: //XOR
-                created_gate = new XorGate(id, level);
+                created_gate = newGate<XorGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 4: //XNOR
-                created_gate = new XnorGate(id, level);
+                created_gate = newGate<XnorGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 5: //DFF
-                created_gate = new DffGate(id, level);
+                created_gate = newGate<DffGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 stateVars.push_back(created_gate);
                 if(num_fanin == 1) {
@@ -97,62 +109,62 @@ void Circuit::readLev(std::string filename, bool delay) {
                 }
                 break;
             case 6: //AND
-                created_gate = new AndGate(id, level);
+                created_gate = newGate<AndGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 7: //NAND
-                created_gate = new NandGate(id, level);
+                created_gate = newGate<NandGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 8: //OR
-                created_gate = new OrGate(id, level);
+                created_gate = newGate<OrGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 9: //NOR
-                created_gate = new NorGate(id, level);
+                created_gate = newGate<NorGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 10: //NOT
-                created_gate = new NotGate(id, level);
+                created_gate = newGate<NotGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 11: //BUF
-                created_gate = new BufGate(id, level);
+                created_gate = newGate<BufGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 12: //TIE1
-                created_gate = new TieOneGate(id, level);
+                created_gate = newGate<TieOneGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 13: //TIE0
-                created_gate = new TieZeroGate(id, level);
+                created_gate = newGate<TieZeroGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 14: //TIEX
-                created_gate = new TieXGate(id, level);
+                created_gate = newGate<TieXGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 15: //TIEZ
-                created_gate = new TieZGate(id, level);
+                created_gate = newGate<TieZGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 16: //MUX2
-                created_gate = new Mux2Gate(id, level);
+                created_gate = newGate<Mux2Gate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
             case 21: //TRISTATE
-                created_gate = new TristateGate(id, level);
+                created_gate = newGate<TristateGate>(id, level, num_fanin, num_fanout);
                 allGates.push_back(created_gate);
                 logicGates.push_back(created_gate);
                 break;
@@ -167,7 +179,7 @@ void Circuit::readLev(std::string filename, bool delay) {
                     fanin->addFanout(created_gate);
                 }
             }
-            created_gate->createGIC();
+            setupGate(created_gate);
 
             if(delay) {
                 if(gate_delays.count(created_gate->type()) != 0) {
@@ -206,6 +218,19 @@ void Circuit::readLev(std::string filename, bool delay) {
     }
 }
 
+//GIC storage and truth table, once the fanins are final
+void Circuit::setupGate(Gate * gate) {
+    gate->createGIC();
+    unsigned int num_fanin = gate->getNumFanin();
+    if(GateKernels::hasGIC(gate->type()) && num_fanin > 0 && num_fanin <= LUT_MAX_FANIN) {
+        //the LUT GIC slot skips no fanins, tie fanins still go through setGIC
+        bool no_ties = (gate->getNumGICPts() == (0x01u << num_fanin));
+        gate->setLUT(getLUT(gate->type(), num_fanin), no_ties);
+    } else {
+        gate->setLUT(NULL, false);
+    }
+}
+
 //KEEP
 void Circuit::readDelay( std::string filename ) {
     std::fstream dly_stream(filename);
@@ -324,6 +349,66 @@ void Circuit::readDelay( std::string filename ) {
     }
 }
 
+void Circuit::readInstanceDelays(std::string filename) {
+    std::fstream dly_stream(filename);
+    if(!dly_stream.is_open()) {
+        std::cerr << "WARNING: NO INSTANCE DELAY FILE " << filename << ", USING GATE TYPE DELAYS" << std::endl;
+        return;
+    }
+    instance_delays.resize(2 * allGates.size());
+    for(unsigned int i = 0; i < allGates.size(); i++) {
+        instance_delays[2 * i] = allGates[i]->getDelay();
+        instance_delays[2 * i + 1] = allGates[i]->getDelay();
+    }
+    std::string line;
+    while(std::getline(dly_stream, line)) {
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        unsigned int gate_id, rise, fall;
+        if(!(ss >> gate_id)) {
+            continue;
+        }
+        if(!(ss >> rise) || gate_id == 0 || gate_id > allGates.size()) {
+            std::cerr << "INVALID LINE IN DELAY FILE: " << line << std::endl;
+            exit(-1);
+        }
+        if(!(ss >> fall)) {
+            fall = rise;
+        }
+        instance_delays[2 * (gate_id - 1)] = rise;
+        instance_delays[2 * (gate_id - 1) + 1] = fall;
+        max_delay = std::max(max_delay, std::max(rise, fall));
+    }
+}
+
+void Circuit::readCapacitance(std::string filename) {
+    if(simplified) {
+        std::cerr << "CAP FILE MUST BE READ BEFORE SIMPLIFY: " << filename << std::endl;
+        exit(-1);
+    }
+    std::fstream cap_stream(filename.c_str(), std::fstream::in);
+    if(!cap_stream.is_open()) {
+        std::cerr << "CANNOT OPEN CAP FILE: " << filename << std::endl;
+        exit(-1);
+    }
+    capacitance.assign(allGates.size(), 0.0);
+    std::string line;
+    while(std::getline(cap_stream, line)) {
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        unsigned int gate_id;
+        double cap;
+        if(!(ss >> gate_id)) {
+            continue;
+        }
+        if(!(ss >> cap) || gate_id == 0 || gate_id > allGates.size()) {
+            std::cerr << "INVALID LINE IN CAP FILE: " << line << std::endl;
+            exit(-1);
+        }
+        capacitance[gate_id - 1] = cap;
+    }
+}
+
 void Circuit::readFaultList(std::string filename) {
     std::string line;
     std::fstream input(filename.c_str(), std::fstream::in);
@@ -340,6 +425,7 @@ void Circuit::readFaultList(std::string filename) {
         ss >> gate_id >> gate_net >> stuck_at_value;
         LogicValue sa = stuck_at_value ? LogicValue::ONE : LogicValue::ZERO;
         faultlist.push_back(Fault(gate_id, gate_net, sa, num_faults));
+        active_faults.push_back(num_faults);
         num_faults++;
     }
 }
@@ -352,36 +438,152 @@ void Circuit::printFaults() {
     }
 }
 
-void Circuit::injectFaults(std::vector<Gate*>& injected_faulty_gates) {
-    //regular injection
-    bool at_least_one_injected = false;
-    while(!at_least_one_injected && injected_fault_idx != faultlist.size()){
-        int stop_idx = injected_fault_idx + NUM_FAULT_INJECT;
-        for(unsigned int i = injected_fault_idx; i < stop_idx; i++){
-            if(i >= faultlist.size()){
-                break;
+/********************************************************/
+// fault collapsing
+/********************************************************/
+
+//gates whose faulty value the fault simulator computes from their fanins
+bool Circuit::isCollapsible(Gate::GateType type) {
+    switch(type) {
+    case Gate::OUTPUT:
+    case Gate::AND:
+    case Gate::NAND:
+    case Gate::OR:
+    case Gate::NOR:
+    case Gate::NOT:
+    case Gate::XOR:
+    case Gate::XNOR:
+    case Gate::BUF:
+        return true;
+    default:
+        return false;
+    }
+}
+
+unsigned int Circuit::findFaultClass(std::vector<unsigned int>& parent, unsigned int fault) {
+    while(parent[fault] != fault) {
+        parent[fault] = parent[parent[fault]];
+        fault = parent[fault];
+    }
+    return fault;
+}
+
+void Circuit::collapseFaults() {
+    //every structural fault, net n of gate g stuck at v is fault_base[g] + 2 * n + (v == ONE)
+    std::vector<unsigned int> fault_base(allGates.size() + 2, 0);
+    for(unsigned int i = 0; i < allGates.size(); i++) {
+        fault_base[i + 2] = fault_base[i + 1] + 2 * (allGates[i]->getNumFanin() + 1);
+    }
+    std::vector<unsigned int> parent(fault_base.back());
+    for(unsigned int i = 0; i < parent.size(); i++) {
+        parent[i] = i;
+    }
+
+    //equivalence
+    for(unsigned int i = 0; i < allGates.size(); i++) {
+        Gate * gate = allGates[i];
+        Gate::GateType type = gate->type();
+        unsigned int out = fault_base[gate->getId()];
+        if(isCollapsible(type)) {
+            int control = (type == Gate::AND || type == Gate::NAND) ? 0 : (type == Gate::OR || type == Gate::NOR) ? 1 : -1;
+            unsigned int invert = (type == Gate::NAND || type == Gate::NOR || type == Gate::NOT || type == Gate::XNOR) ? 1 : 0;
+            for(unsigned int j = 0; j < gate->getNumFanin(); j++) {
+                for(unsigned int v = 0; v < 2; v++) {
+                    if(int(v) == control || gate->getNumFanin() == 1) {
+                        parent[findFaultClass(parent, out + 2 * (j + 1) + v)] = findFaultClass(parent, out + (v ^ invert));
+                    }
+                }
             }
-        
-            if(faultlist[i].isDetected()){
-                injected_fault_idx++;
-                continue;
+        }
+        //a stem with a single fanout is the pin it drives
+        if((isCollapsible(type) || type == Gate::INPUT) && gate->getNumFanout() == 1 && isCollapsible(gate->getFanout(0)->type())) {
+            Gate * fout = gate->getFanout(0);
+            unsigned int pin = 0;
+            unsigned int count = 0;
+            for(unsigned int j = 0; j < fout->getNumFanin(); j++) {
+                if(fout->getFanin(j) == gate) {
+                    pin = j + 1;
+                    count++;
+                }
             }
-        
-            //inject state
-            std::vector<Gate*> f_state_events;
-            faultlist[i].injectState(f_state_events);
-            for(unsigned int j = 0; j<f_state_events.size(); j++){
-                injected_faulty_gates.push_back(f_state_events[j]);
+            if(count == 1) {
+                for(unsigned int v = 0; v < 2; v++) {
+                    parent[findFaultClass(parent, fault_base[fout->getId()] + 2 * pin + v)] = findFaultClass(parent, out + v);
+                }
             }
-        
-            //inject direct faults, overwrites state vals.
-            Gate * to_inject = getGateById(faultlist[i].faultGateId());
-            to_inject->addFault(&faultlist[i]);
+        }
+    }
+
+    //first listed fault of a class is its representative
+    const unsigned int NO_REP = 0xFFFFFFFF;
+    std::vector<unsigned int> class_rep(parent.size(), NO_REP);
+    for(unsigned int i = 0; i < faultlist.size(); i++) {
+        Fault& flt = faultlist[i];
+        Gate * gate = getGateById(flt.faultGateId());
+        if(!gate || flt.faultGateNet() > gate->getNumFanin()) {
+            continue;
+        }
+        unsigned int root = findFaultClass(parent, fault_base[flt.faultGateId()] + 2 * flt.faultGateNet() + (flt.faultSA() == LogicValue::ONE));
+        if(class_rep[root] == NO_REP) {
+            class_rep[root] = i;
+        } else {
+            flt.setEquivalent(&faultlist[class_rep[root]]);
+        }
+    }
 
-            injected_faulty_gates.push_back(to_inject);
-            injected_fault_idx++;
-            at_least_one_injected = true;
+    //dominance, any pattern detecting a non controlling input fault detects the output fault
+    dominance.clear();
+    for(unsigned int i = 0; i < allGates.size(); i++) {
+        Gate * gate = allGates[i];
+        Gate::GateType type = gate->type();
+        if((type != Gate::AND && type != Gate::NAND && type != Gate::OR && type != Gate::NOR) || gate->getNumFanin() < 2) {
+            continue;
+        }
+        unsigned int non_control = (type == Gate::AND || type == Gate::NAND) ? 1 : 0;
+        unsigned int invert = (type == Gate::NAND || type == Gate::NOR) ? 1 : 0;
+        unsigned int out = fault_base[gate->getId()];
+        unsigned int dominating = class_rep[findFaultClass(parent, out + (non_control ^ invert))];
+        if(dominating == NO_REP) {
+            continue;
         }
+        for(unsigned int j = 0; j < gate->getNumFanin(); j++) {
+            unsigned int dominated = class_rep[findFaultClass(parent, out + 2 * (j + 1) + non_control)];
+            if(dominated != NO_REP) {
+                dominance.push_back(std::make_pair(dominating, dominated));
+            }
+        }
+    }
+}
+
+void Circuit::applyDominance() {
+    for(unsigned int i = 0; i < dominance.size(); i++) {
+        if(!faultlist[dominance[i].first].isDetected() && faultlist[dominance[i].second].isDetected()) {
+            faultlist[dominance[i].first].setDetected();
+        }
+    }
+}
+
+void Circuit::resetInjection() {
+    unsigned int kept = 0;
+    for(unsigned int i = 0; i < active_faults.size(); i++) {
+        const Fault& flt = faultlist[active_faults[i]];
+        if(!flt.isDetected() && !flt.isCollapsed()) {
+            active_faults[kept++] = active_faults[i];
+        }
+    }
+    active_faults.resize(kept);
+}
+
+void Circuit::injectFaults(FaultGroup & group, std::vector<Gate*>& injected_faulty_gates, unsigned int first, unsigned int last) {
+    for(unsigned int i = first; i < last && !group.isFull(); i++) {
+        Fault& flt = faultlist[active_faults[i]];
+        unsigned int slot = group.addFault(&flt);
+
+        //inject state
+        flt.injectState(group, slot, injected_faulty_gates);
+
+        //inject direct faults, overwrites state vals.
+        injected_faulty_gates.push_back(getGateById(flt.faultGateId()));
     }
 }
 
@@ -396,17 +598,307 @@ double Circuit::calculateFaultCov() const{
     return ((double) count) / faultlist.size();
 }
 
+/********************************************************/
+// load time simplification
+/********************************************************/
 
+Gate * Circuit::createGate(Gate::GateType type, unsigned int id, unsigned int level, size_t num_fanin, size_t num_fanout) {
+    switch(type) {
+    case Gate::AND:
+        return newGate<AndGate>(id, level, num_fanin, num_fanout);
+    case Gate::NAND:
+        return newGate<NandGate>(id, level, num_fanin, num_fanout);
+    case Gate::OR:
+        return newGate<OrGate>(id, level, num_fanin, num_fanout);
+    case Gate::NOR:
+        return newGate<NorGate>(id, level, num_fanin, num_fanout);
+    case Gate::TIE_ZERO:
+        return newGate<TieZeroGate>(id, level, num_fanin, num_fanout);
+    case Gate::TIE_ONE:
+        return newGate<TieOneGate>(id, level, num_fanin, num_fanout);
+    default:
+        std::cerr << "CANNOT CREATE GATE TYPE " << type << std::endl;
+        exit(-1);
+    }
+}
+
+//swaps gate for a new gate of type with the same id and fanouts. Tie cells drop the fanins,
+//other types keep them. The old gate is destroyed.
+Gate * Circuit::replaceGate(Gate * gate, Gate::GateType type) {
+    bool is_tie = (type == Gate::TIE_ZERO) || (type == Gate::TIE_ONE);
+    Gate * replacement = createGate(type, gate->getId(), gate->getLevel(), is_tie ? 0 : gate->getNumFanin(), gate->getNumFanout());
+    replacement->setDelay(gate_delays.count(type) ? gate_delays[type] : gate->getDelay());
+    for(unsigned int i = 0; i < gate->getNumFanin(); i++) {
+        Gate * fanin = gate->getFanin(i);
+        if(is_tie) {
+            fanin->removeFanout(gate);
+        } else {
+            replacement->addFanin(fanin);
+            fanin->replaceFanout(gate, replacement);
+        }
+    }
+    for(unsigned int i = 0; i < gate->getNumFanout(); i++) {
+        Gate * fanout = gate->getFanout(i);
+        fanout->replaceFanin(gate, replacement);
+        replacement->addFanout(fanout);
+    }
+    allGates[gate->getId() - 1] = replacement;
+    gate->~Gate();
+    return replacement;
+}
 
-void Circuit::invalidateFaultArrays(){
-    for(int i = 0; i<allGates.size(); i++){
-        allGates[i]->clearFaultValid();
+//moves the faults on net of from (0 the output, k fanin k) to to_net of to,
+//complementing the stuck at value if invert
+void Circuit::relocateFaults(Gate * from, unsigned int net, Gate * to, unsigned int to_net, bool invert) {
+    std::vector<unsigned int>& here = faults_at[from->getId()];
+    std::vector<unsigned int> moved;
+    for(unsigned int i = 0; i < here.size(); ) {
+        Fault& flt = faultlist[here[i]];
+        if(flt.faultGateNet() == net) {
+            moved.push_back(here[i]);
+            here[i] = here.back();
+            here.pop_back();
+        } else {
+            i++;
+        }
+    }
+    for(unsigned int i = 0; i < moved.size(); i++) {
+        Fault& flt = faultlist[moved[i]];
+        flt.relocate(to->getId(), to_net, invert ? ~flt.faultSA() : flt.faultSA());
+        faults_at[to->getId()].push_back(moved[i]);
     }
 }
 
+void Circuit::simplify() {
+    if(netlist) {
+        std::cerr << "SIMPLIFY MUST RUN BEFORE THE NETLIST IS BUILT" << std::endl;
+        exit(-1);
+    }
+    size_t num_gates = allGates.size();
+    std::vector<bool> removed(num_gates + 1, false);
+    faults_at.assign(num_gates + 1, std::vector<unsigned int>());
+    for(unsigned int i = 0; i < faultlist.size(); i++) {
+        faults_at[faultlist[i].faultGateId()].push_back(i);
+    }
+    std::vector<unsigned int> logic_ids;
+    for(unsigned int i = 0; i < logicGates.size(); i++) {
+        logic_ids.push_back(logicGates[i]->getId());
+    }
+    //level order, so a gate sees the already simplified gates in its fanin cone.
+    //gates are looked up by id since replaceGate swaps objects.
+    std::vector<std::pair<unsigned int, unsigned int> > by_level;
+    for(unsigned int i = 0; i < num_gates; i++) {
+        by_level.push_back(std::make_pair(allGates[i]->getLevel(), allGates[i]->getId()));
+    }
+    std::sort(by_level.begin(), by_level.end());
+
+    //buffers: fanouts read the buffer's driver directly. The buffer output stem is only equivalent
+    //to the driver output when the driver has no other fanout, which fault simulation requires.
+    //A DFF reading an input or another DFF sees its current cycle value, so those buffers stay.
+    for(unsigned int i = 0; i < by_level.size(); i++) {
+        Gate * buf = getGateById(by_level[i].second);
+        if(buf->type() != Gate::BUF) continue;
+        Gate * driver = buf->getFanin(0);
+        if(fault_sim && driver->getNumFanout() != 1) continue;
+        bool feeds_dff = false;
+        for(unsigned int j = 0; j < buf->getNumFanout(); j++) {
+            feeds_dff |= (buf->getFanout(j)->type() == Gate::D_FF);
+        }
+        if(feeds_dff && (driver->type() == Gate::INPUT || driver->type() == Gate::D_FF)) continue;
+
+        relocateFaults(buf, 0, driver, 0, false);
+        relocateFaults(buf, 1, driver, 0, false);
+        driver->removeFanout(buf);
+        for(unsigned int j = 0; j < buf->getNumFanout(); j++) {
+            buf->getFanout(j)->replaceFanin(buf, driver);
+            driver->addFanout(buf->getFanout(j));
+        }
+        buf->clearFanin();
+        buf->clearFanout();
+        removed[buf->getId()] = true;
+    }
+
+    //tie constants: gates with a controlling tie fanin or only tie fanins become tie cells, other
+    //tie fanins of AND/NAND/OR/NOR are dropped. FaultSimulator never evaluates tie cells, its tie
+    //nets stay X, so with faults loaded they are left alone to keep coverage the same.
+    for(unsigned int i = 0; i < by_level.size() && !fault_sim; i++) {
+        Gate * gate = getGateById(by_level[i].second);
+        if(removed[gate->getId()]) continue;
+        Gate::GateType type = gate->type();
+        bool counted = GateKernels::isCounted(type);
+        if(!counted && type != Gate::NOT && type != Gate::XOR && type != Gate::XNOR) continue;
+        LogicValue controlling = (type == Gate::AND || type == Gate::NAND) ? LogicValue::ZERO : LogicValue::ONE;
+
+        std::vector<unsigned char> vals(gate->getNumFanin());
+        std::vector<unsigned int> fin(gate->getNumFanin());
+        bool all_tied = true;
+        bool is_controlled = false;
+        for(unsigned int j = 0; j < gate->getNumFanin(); j++) {
+            Gate::GateType fanin_type = gate->getFanin(j)->type();
+            if(fanin_type != Gate::TIE_ZERO && fanin_type != Gate::TIE_ONE) {
+                all_tied = false;
+                continue;
+            }
+            LogicValue tied = (fanin_type == Gate::TIE_ONE) ? LogicValue::ONE : LogicValue::ZERO;
+            vals[j] = tied.val;
+            fin[j] = j;
+            is_controlled |= counted && (tied == controlling);
+        }
+        if(is_controlled || all_tied) {
+            LogicValue val;
+            if(is_controlled) {
+                val = (type == Gate::NAND || type == Gate::NOR) ? ~controlling : controlling;
+            } else {
+                val = GateKernels::get(type, gate->getNumFanin())(vals.data(), fin.data(), gate->getNumFanin());
+            }
+            std::vector<Gate *> fanins;
+            for(unsigned int j = 0; j < gate->getNumFanin(); j++) {
+                fanins.push_back(gate->getFanin(j));
+            }
+            replaceGate(gate, (val == LogicValue::ONE) ? Gate::TIE_ONE : Gate::TIE_ZERO);
+            for(unsigned int j = 0; j < fanins.size(); j++) {
+                if(fanins[j]->getNumFanout() == 0 && GateKernels::isConstant(fanins[j]->type())) {
+                    removed[fanins[j]->getId()] = true;
+                }
+            }
+            continue;
+        }
+        for(unsigned int k = gate->getNumFanin(); counted && k-- > 0; ) {
+            Gate * tie = gate->getFanin(k);
+            if(tie->type() != Gate::TIE_ZERO && tie->type() != Gate::TIE_ONE) continue;
+            gate->removeFanin(k);
+            tie->removeFanout(gate);
+            if(tie->getNumFanout() == 0) {
+                removed[tie->getId()] = true;
+            }
+        }
+    }
+
+    //inverter absorption: AND/NAND/OR/NOR driving only a NOT becomes its complement and takes over
+    //the NOT's fanouts. The NOT input and output nets are the gate output net, inverted or not.
+    for(unsigned int i = 0; i < by_level.size(); i++) {
+        Gate * inv = getGateById(by_level[i].second);
+        if(removed[inv->getId()] || inv->type() != Gate::NOT) continue;
+        Gate * gate = inv->getFanin(0);
+        if(!GateKernels::isCounted(gate->type()) || gate->getNumFanout() != 1) continue;
+
+        Gate::GateType complement;
+        switch(gate->type()) {
+        case Gate::AND:  complement = Gate::NAND; break;
+        case Gate::NAND: complement = Gate::AND;  break;
+        case Gate::OR:   complement = Gate::NOR;  break;
+        default:         complement = Gate::OR;   break;
+        }
+        gate->removeFanout(inv);
+        Gate * merged = replaceGate(gate, complement);
+        relocateFaults(merged, 0, merged, 0, true);
+        relocateFaults(inv, 1, merged, 0, true);
+        relocateFaults(inv, 0, merged, 0, false);
+        for(unsigned int j = 0; j < inv->getNumFanout(); j++) {
+            inv->getFanout(j)->replaceFanin(inv, merged);
+            merged->addFanout(inv->getFanout(j));
+        }
+        inv->clearFanin();
+        inv->clearFanout();
+        removed[inv->getId()] = true;
+    }
+
+    //compact the ids, faults follow their gates and faults landing on the same net collapse
+    std::vector<unsigned int> new_id(num_gates + 1, 0);
+    std::vector<Gate *> kept;
+    for(unsigned int i = 0; i < num_gates; i++) {
+        if(removed[i + 1]) {
+            allGates[i]->~Gate();
+            continue;
+        }
+        kept.push_back(allGates[i]);
+        new_id[i + 1] = kept.size();
+    }
+    std::vector<Gate *> kept_logic;
+    for(unsigned int i = 0; i < logic_ids.size(); i++) {
+        if(!removed[logic_ids[i]]) {
+            kept_logic.push_back(allGates[logic_ids[i] - 1]);
+        }
+    }
+    if(!instance_delays.empty()) {
+        std::vector<unsigned int> kept_delays;
+        for(unsigned int i = 0; i < num_gates; i++) {
+            if(!removed[i + 1]) {
+                kept_delays.push_back(instance_delays[2 * i]);
+                kept_delays.push_back(instance_delays[2 * i + 1]);
+            }
+        }
+        instance_delays.swap(kept_delays);
+    }
+    if(!capacitance.empty()) {
+        std::vector<double> kept_caps;
+        for(unsigned int i = 0; i < num_gates; i++) {
+            if(!removed[i + 1]) {
+                kept_caps.push_back(capacitance[i]);
+            }
+        }
+        capacitance.swap(kept_caps);
+    }
+    allGates = kept;
+    logicGates = kept_logic;
+    for(unsigned int i = 0; i < allGates.size(); i++) {
+        allGates[i]->setId(i + 1);
+        allGates[i]->renumberAdjacency(new_id);
+        setupGate(allGates[i]);
+    }
+
+    std::map<std::pair<std::pair<unsigned int, unsigned int>, unsigned char>, Fault *> by_net;
+    for(unsigned int i = 0; i < faultlist.size(); i++) {
+        Fault& flt = faultlist[i];
+        flt.relocate(new_id[flt.faultGateId()], flt.faultGateNet(), flt.faultSA());
+        std::pair<std::pair<unsigned int, unsigned int>, unsigned char> net(std::make_pair(flt.faultGateId(), flt.faultGateNet()), flt.faultSA().val);
+        if(flt.isCollapsed()) {
+            continue;
+        }
+        if(by_net.count(net)) {
+            flt.setEquivalent(by_net[net]);
+        } else {
+            by_net[net] = &flt;
+        }
+    }
+    faults_at.clear();
+    simplified = true;
+}
+
+std::vector<unsigned int> Circuit::getLevelSizes() {
+    std::vector<unsigned int> sizes(num_levels, 0);
+    for(unsigned int i = 0; i < allGates.size(); i++) {
+        sizes[allGates[i]->getLevel()]++;
+    }
+    return sizes;
+}
+
+FlatNetlist * Circuit::getNetlist() {
+    if(!netlist) {
+        netlist = new FlatNetlist(this);
+    }
+    return netlist;
+}
+
+const unsigned char * Circuit::getLUT(Gate::GateType type, unsigned int num_fanin) {
+    unsigned int idx = type * (LUT_MAX_FANIN + 1) + num_fanin;
+    if(luts.size() <= idx) {
+        luts.resize(idx + 1, NULL);
+    }
+    if(!luts[idx]) {
+        luts[idx] = new GateLUT(type, num_fanin);
+    }
+    return luts[idx]->data();
+}
+
 Circuit::~Circuit() {
+    delete netlist;
+    for(size_t i = 0; i < luts.size(); i++) {
+        delete luts[i];
+    }
+    //gate storage goes with the arena, only the destructors are run here
     for(size_t i = 0; i<allGates.size(); i++) {
-        delete allGates[i];
+        allGates[i]->~Gate();
     }
 
 }
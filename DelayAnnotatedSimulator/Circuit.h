@@ -38,13 +38,27 @@
 
 #include "Gates.h"
 #include "Fault.h"
+#include "GateLUT.h"
 #include "Type.h"
 
 #define FF_GROUPING_SIZE_DEFAULT 5
+
+class FlatNetlist;
+
 //Circuit Class
 
 class Circuit {
 private:
+    //owns the gates, their adjacency and GIC bitmaps, all freed at once with the circuit
+    Arena arena;
+    template <class G>
+    G * newGate(unsigned int id, unsigned int level, size_t num_fanin, size_t num_fanout) {
+        G * gate = new (arena.allocate(sizeof(G), alignof(G))) G(id, level);
+        gate->useArena(&arena, num_fanin, num_fanout);
+        gate->setGateTable(&allGates);
+        return gate;
+    }
+
     //define references for cleanup, set up and simulations
     std::vector<Gate*> allGates;
     std::vector<Gate*> inputs;
@@ -52,32 +66,83 @@ private:
     std::vector<Gate*> outputs;
     std::vector<Gate*> logicGates;
     std::map<Gate::GateType, unsigned int> gate_delays;
+    //per instance delays from <ckt_name>.idly, rise of gate id g at [2 * (g - 1)] and fall at [2 * (g - 1) + 1].
+    //empty when every gate uses its type delay for both.
+    std::vector<unsigned int> instance_delays;
+    //switched capacitance of gate id g at [g - 1] from <ckt_name>.cap, empty without a cap file
+    std::vector<double> capacitance;
+    bool simplified; //gate ids no longer match the .lev file
     unsigned int num_levels;
     unsigned int max_delay;
     unsigned int grouping_size;
 
     std::vector<std::vector<bool> > stateGICCoverage;
+
+    //flattened copy for the simulators, built on first use
+    FlatNetlist * netlist;
+
+    //truth tables shared by all gates of a type and fanin count,
+    //indexed type * (LUT_MAX_FANIN + 1) + num_fanin, built on first use
+    std::vector<GateLUT *> luts;
+    const unsigned char * getLUT(Gate::GateType type, unsigned int num_fanin);
     
 
     //fault info
     std::vector<Fault> faultlist;
-    unsigned int injected_fault_idx;
+    std::vector<unsigned int> active_faults; //faultlist indices still simulated, detected faults are dropped for good
+    std::vector<std::pair<unsigned int, unsigned int> > dominance; //faultlist indices of (dominating, dominated) faults
+    bool fault_sim; //loaded with a fault list
+
+    //simplify() bookkeeping
+    std::vector<std::vector<unsigned int> > faults_at; //faultlist indices by gate id
+    void setupGate(Gate * gate);
+    Gate * createGate(Gate::GateType type, unsigned int id, unsigned int level, size_t num_fanin, size_t num_fanout);
+    Gate * replaceGate(Gate * gate, Gate::GateType type);
+    void relocateFaults(Gate * from, unsigned int net, Gate * to, unsigned int to_net, bool invert);
+
+    //collapseFaults() helpers
+    static bool isCollapsible(Gate::GateType type);
+    static unsigned int findFaultClass(std::vector<unsigned int>& parent, unsigned int fault);
 
 public:
     Gate* global_reset;
     Circuit(std::string filename, bool delay, bool fault, unsigned int grouping_size = FF_GROUPING_SIZE_DEFAULT)
-    : grouping_size(grouping_size) {
+    : simplified(false), num_levels(1), max_delay(1), grouping_size(grouping_size), netlist(NULL), fault_sim(fault) {
         if(delay) readDelay(filename + ".dly"); //KEEP
         if(fault) readFaultList(filename + ".eqf");
         readLev(filename + ".lev", delay);
-        injected_fault_idx = 0;
+        if(fault) collapseFaults();
+        if(delay) readInstanceDelays(filename + ".idly");
     };
 
     ~Circuit();
 
     void readLev(std::string filename, bool delay); //KEEP
     void readFaultList(std::string filename);
+    //structural fault collapsing over the loaded netlist. Faults that leave the same faulty circuit
+    //(controlling value on a gate input and the matching output fault, inverter and buffer pins,
+    //fanout free stems and the pin they drive) form a class and only its first listed fault is
+    //simulated. Flip flops and the cells the fault simulator does not evaluate are left out.
+    //Also records which AND/NAND/OR/NOR output faults dominate their non controlling input faults.
+    void collapseFaults();
+    //marks the dominating faults of detected faults. Only holds when every pattern starts from a
+    //scanned in state, a sequential test for the input fault need not detect the output fault.
+    void applyDominance();
     void readDelay(std::string filename); //KEEP
+    //lines of "<gate_id> <rise> <fall>" (or "<gate_id> <delay>" for both), # starts a comment.
+    //gates not listed keep their type delay. A missing file only warns, every gate keeps its type delay.
+    void readInstanceDelays(std::string filename);
+    //lines of "<gate_id> <capacitance>" in the ids of the .lev file, # starts a comment. Gates not
+    //listed do not count towards the switched capacitance. Must be read before simplify(), which
+    //remaps it like the instance delays.
+    void readCapacitance(std::string filename);
+
+    //optional load time pass: removes buffers, drops or folds tie constants and merges inverters
+    //into the AND/NAND/OR/NOR driving them. Gates are renumbered and the fault list is remapped to
+    //equivalent faults, calculateFaultCov still reports over every fault read. POs and state are
+    //unchanged, GIC and toggle coverage are over the simplified gates. Call before getNetlist().
+    //The removed cells' type and instance delays go with them, so it is not for delay simulation.
+    void simplify();
 
     std::vector<Gate*> getInputs() {
         return inputs;
@@ -106,6 +171,7 @@ public:
     inline size_t getNumGates() {
         return allGates.size();
     }
+    std::vector<unsigned int> getLevelSizes(); //number of gates on each level
     inline Gate* getStateVar(unsigned int idx) {
         return ((idx < stateVars.size()) ? stateVars[idx] : NULL);
     }
@@ -118,17 +184,35 @@ public:
     inline unsigned int getMaxDelay() {
         return max_delay;
     }
+    inline unsigned int getRiseDelay(unsigned int gate_id) {
+        return instance_delays.empty() ? allGates[gate_id-1]->getDelay() : instance_delays[2 * (gate_id - 1)];
+    }
+    inline unsigned int getFallDelay(unsigned int gate_id) {
+        return instance_delays.empty() ? allGates[gate_id-1]->getDelay() : instance_delays[2 * (gate_id - 1) + 1];
+    }
+    inline bool hasCapacitance() const {
+        return !capacitance.empty();
+    }
+    inline double getCapacitance(unsigned int gate_id) const {
+        return capacitance[gate_id - 1];
+    }
+    FlatNetlist * getNetlist();
     
     //this can be used to aid in limiting memory footprint
-    void injectFaults(std::vector<Gate*>&);
-    void invalidateFaultArrays();
+    //injects active faults first .. last - 1 into the group and returns the gates to schedule.
+    //Only touches the injected faults, so disjoint ranges can be injected from different threads.
+    void injectFaults(FaultGroup & group, std::vector<Gate*>&, unsigned int first, unsigned int last);
     double calculateFaultCov() const;
     inline size_t numFaults() {
         return faultlist.size();
     }
-    inline void resetInjection() {
-        injected_fault_idx = 0;
-
+    inline Fault * getFault(unsigned int idx) {
+        return &faultlist[idx];
+    }
+    //drops the faults detected or collapsed since the last call from the active faults, O(active faults)
+    void resetInjection();
+    inline size_t numActiveFaults() const {
+        return active_faults.size();
     }
     void printFaults();
     
@@ -142,7 +226,7 @@ public:
                     break;
                 }
                 
-                if(stateVars[i+j]->getOut() == LogicValue::ONE){
+                if(stateVars[(i*grouping_size)+j]->getOut() == LogicValue::ONE){
                     idx = (idx << 1) | 0x01;
                 } else {
                     idx = (idx << 1);
@@ -177,6 +261,9 @@ public:
         assert(grouping_size != 0);
         grouping_size = size;
     }
+    inline unsigned int getGICGroupingSize() {
+        return grouping_size;
+    }
     
     double calculateGIC(){
         unsigned int num_pts = 0;
@@ -0,0 +1,210 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "CompiledCircuit.h"
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define COMPILED_CYCLE_SYMBOL "fsim_cycle"
+
+//runs $CXX (split on whitespace, c++ if unset) on source without a shell, so neither path is
+//ever interpreted. Returns the exit status, -1 if the compiler could not be run.
+static int compile(const std::string& source, const std::string& library) {
+    const char * cxx = getenv("CXX");
+    std::vector<std::string> words;
+    std::stringstream ss((cxx != NULL) ? cxx : "");
+    std::string word;
+    while(ss >> word) {
+        words.push_back(word);
+    }
+    if(words.empty()) {
+        words.push_back("c++");
+    }
+    words.push_back("-O2");
+    words.push_back("-shared");
+    words.push_back("-fPIC");
+    words.push_back("-o");
+    words.push_back(library);
+    words.push_back(source);
+
+    std::vector<char *> argv;
+    for(unsigned int i = 0; i < words.size(); i++) {
+        argv.push_back(const_cast<char *>(words[i].c_str()));
+    }
+    argv.push_back(NULL);
+
+    pid_t pid = fork();
+    if(pid < 0) {
+        return -1;
+    }
+    if(pid == 0) {
+        execvp(argv[0], &argv[0]);
+        _exit(127);
+    }
+    int status;
+    while(waitpid(pid, &status, 0) < 0) {
+        if(errno != EINTR) {
+            return -1;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+CompiledCircuit::CompiledCircuit(const FlatNetlist * netlist, const std::string& name) {
+    std::string source = name + "_sim.cpp";
+    std::string library = name + "_sim.so";
+    std::fstream out(source.c_str(), std::fstream::out);
+    if(!out.is_open()) {
+        std::cerr << "CANNOT WRITE " << source << std::endl;
+        exit(-1);
+    }
+    generate(netlist, out);
+    out.close();
+
+    if(compile(source, library) != 0) {
+        std::cerr << "COMPILE FAILED: " << source << std::endl;
+        remove(source.c_str());
+        exit(-1);
+    }
+
+    //dlopen only searches the working directory for paths with a slash
+    std::string path = (library.find('/') == std::string::npos) ? "./" + library : library;
+    handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    //the loaded mapping outlives the files
+    remove(library.c_str());
+    remove(source.c_str());
+    if(handle == NULL) {
+        std::cerr << "DLOPEN FAILED: " << dlerror() << std::endl;
+        exit(-1);
+    }
+    cycle = (CompiledCycle) dlsym(handle, COMPILED_CYCLE_SYMBOL);
+    if(cycle == NULL) {
+        std::cerr << "DLSYM FAILED: " << dlerror() << std::endl;
+        exit(-1);
+    }
+}
+
+CompiledCircuit::~CompiledCircuit() {
+    dlclose(handle);
+}
+
+static std::string operand(unsigned int gate) {
+    std::stringstream ss;
+    ss << "v[" << gate << "]";
+    return ss.str();
+}
+
+//expression for gate's output, folding the fanins left to right like the GateKernels
+static std::string gateExpression(const FlatNetlist * netlist, unsigned int gate) {
+    const unsigned int * fin = netlist->faninBegin(gate);
+    unsigned int num_fanin = netlist->getNumFanin(gate);
+    const char * op = NULL;
+    bool invert = false;
+
+    switch(netlist->type(gate)) {
+    case Gate::NAND:
+        invert = true;
+        //fall through
+    case Gate::AND:
+        op = "lv_and";
+        break;
+    case Gate::NOR:
+        invert = true;
+        //fall through
+    case Gate::OR:
+        op = "lv_or";
+        break;
+    case Gate::XNOR:
+        invert = true;
+        //fall through
+    case Gate::XOR:
+        op = "lv_xor";
+        break;
+    case Gate::NOT:
+        return "lv_not(" + operand(fin[0]) + ")";
+    case Gate::BUF:
+    case Gate::OUTPUT:
+    case Gate::D_FF:
+        return operand(fin[0]);
+    case Gate::MUX_2:
+        return "lv_mux(" + operand(fin[0]) + ", " + operand(fin[1]) + ", " + operand(fin[2]) + ")";
+    case Gate::TRISTATE:
+        return "lv_tri(" + operand(fin[0]) + ", " + operand(fin[1]) + ")";
+    case Gate::TIE_ZERO:
+        return "LV_ZERO";
+    case Gate::TIE_ONE:
+        return "LV_ONE";
+    case Gate::TIE_Z:
+        return "LV_Z";
+    default: //TIE_X, NONE
+        return "LV_X";
+    }
+
+    std::string folded = operand(fin[0]);
+    for(unsigned int i = 1; i < num_fanin; i++) {
+        folded = std::string(op) + "(" + folded + ", " + operand(fin[i]) + ")";
+    }
+    return invert ? "lv_not(" + folded + ")" : folded;
+}
+
+void CompiledCircuit::generate(const FlatNetlist * netlist, std::ostream& out) {
+    //same encoding and operators as LogicValue in Type.h
+    out << "//generated by fsim, do not edit\n"
+        << "typedef unsigned char lv;\n"
+        << "#define LV_ZERO 0\n#define LV_X 1\n#define LV_Z 2\n#define LV_ONE 3\n"
+        << "static inline lv lv_and(lv a, lv b) { return a & b; }\n"
+        << "static inline lv lv_or(lv a, lv b) { return a | b; }\n"
+        << "static inline lv lv_xor(lv a, lv b) { return (a == LV_X || b == LV_X) ? LV_X : (a ^ b); }\n"
+        << "static inline lv lv_not(lv a) { return (a == LV_X) ? LV_X : (LV_ONE - a); }\n"
+        << "static inline lv lv_mux(lv s, lv a, lv b) { return (s == LV_ZERO) ? a : ((s == LV_ONE) ? b : LV_X); }\n"
+        << "static inline lv lv_tri(lv d, lv en) { return (en == LV_ZERO) ? d : LV_Z; }\n\n"
+        << "extern \"C\" void " << COMPILED_CYCLE_SYMBOL << "(lv * v) {\n";
+
+    //flip flops latch in stateVars order, so one fed by an earlier flip flop sees its new value
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        unsigned int dff = netlist->getStateVar(i);
+        out << "    v[" << dff << "] = " << gateExpression(netlist, dff) << ";\n";
+    }
+
+    std::vector<std::vector<unsigned int> > levels(netlist->getNumLevels());
+    for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+        if(netlist->type(i) != Gate::INPUT && netlist->type(i) != Gate::D_FF) {
+            levels[netlist->getLevel(i)].push_back(i);
+        }
+    }
+    for(unsigned int level = 0; level < levels.size(); level++) {
+        for(unsigned int i = 0; i < levels[level].size(); i++) {
+            unsigned int gate = levels[level][i];
+            out << "    v[" << gate << "] = " << gateExpression(netlist, gate) << ";\n";
+        }
+    }
+    out << "}\n";
+}
@@ -0,0 +1,56 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef __DelayAnnotatedSimulator__CompiledCircuit__
+#define __DelayAnnotatedSimulator__CompiledCircuit__
+
+#include <string>
+#include <iostream>
+#include "FlatNetlist.h"
+
+//one clock cycle over an array of LogicValue::VALUES indexed like the FlatNetlist,
+//primary inputs must already be set.
+typedef void (*CompiledCycle)(unsigned char * values);
+
+//Compiled code simulation. The netlist is written out as straight-line C++ (flip flops latch in
+//stateVars order, then every other gate in level order), built with the system compiler into a
+//shared object and loaded with dlopen. The compiler is $CXX, c++ if unset, run directly rather than
+//through a shell.
+class CompiledCircuit {
+private:
+    void * handle;
+    CompiledCycle cycle;
+public:
+    //writes <name>_sim.cpp, builds <name>_sim.so and loads it, then removes both. Exits on failure.
+    CompiledCircuit(const FlatNetlist * netlist, const std::string& name);
+    ~CompiledCircuit();
+
+    inline void simCycle(unsigned char * values) const {
+        cycle(values);
+    }
+
+    static void generate(const FlatNetlist * netlist, std::ostream& out);
+};
+
+#endif /* defined(__DelayAnnotatedSimulator__CompiledCircuit__) */
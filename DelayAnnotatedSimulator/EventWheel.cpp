@@ -29,63 +29,179 @@
  * Base Zero Delay event wheel
  *
  *****************************************************************************/
-void EventWheel::insertEvent(Gate * gate) {
-    if(!gate->isScheduled()) {
-        scheduled_events.at(gate->getLevel()).push(gate);
-        gate->setScheduled();
+EventWheel::EventWheel(const std::vector<unsigned int>& level_sizes, size_t num_gates) :
+    level_head(level_sizes.size(), 0), level_count(level_sizes.size(), 0), occupied((level_sizes.size() + 63) / 64, 0),
+    scheduled(num_gates, false), current_event_queue(0)
+{
+    level_start.resize(level_sizes.size() + 1);
+    level_start[0] = 0;
+    for(unsigned int i = 0; i < level_sizes.size(); i++) {
+        level_start[i + 1] = level_start[i] + level_sizes[i];
     }
+    ring.resize(level_start.back());
 }
 
-Gate * EventWheel::getNextScheduled() {
-    while(scheduled_events.at(current_event_queue).size() == 0) {
-        if(current_event_queue == scheduled_events.size()-1) { //reached end of wheel (sim round is done.)
-            current_event_queue = 0;
-            return NULL;
-        }
-        current_event_queue++;
+void EventWheel::insertEvent(unsigned int gate, unsigned int level) {
+    if(scheduled[gate]) {
+        return;
+    }
+    unsigned int capacity = level_start[level + 1] - level_start[level];
+    if(level_count[level] == capacity) {
+        std::cerr << "EVENT WHEEL LEVEL " << level << " OVERFLOW" << std::endl;
+        exit(-1);
+    }
+    unsigned int slot = level_head[level] + level_count[level];
+    if(slot >= capacity) {
+        slot -= capacity;
     }
+    ring[level_start[level] + slot] = gate;
+    level_count[level]++;
+    markOccupied(level);
+    scheduled[gate] = true;
+}
 
-    Gate * ret = scheduled_events.at(current_event_queue).front();
-    scheduled_events.at(current_event_queue).pop();
-    ret->unsetScheduled();
-    return ret;
+unsigned int EventWheel::nextOccupied(unsigned int level) const {
+    unsigned int word = level >> 6;
+    if(word >= occupied.size()) {
+        return NO_EVENT;
+    }
+    uint64_t bits = occupied[word] & (~uint64_t(0) << (level & 63));
+    while(bits == 0) {
+        if(++word == occupied.size()) {
+            return NO_EVENT;
+        }
+        bits = occupied[word];
+    }
+    return (word << 6) + __builtin_ctzll(bits);
 }
 
-void EventWheel::clearWheel() {
-    scheduled_set.clear();
+unsigned int EventWheel::getNextScheduled() {
+    unsigned int level = nextOccupied(current_event_queue);
+    if(level == NO_EVENT) { //reached end of wheel (sim round is done.)
+        current_event_queue = 0;
+        return NO_EVENT;
+    }
+    current_event_queue = level;
+
+    unsigned int ret = ring[level_start[level] + level_head[level]];
+    unsigned int capacity = level_start[level + 1] - level_start[level];
+    if(++level_head[level] == capacity) {
+        level_head[level] = 0;
+    }
+    if(--level_count[level] == 0) {
+        markEmpty(level);
+    }
+    scheduled[ret] = false;
+    return ret;
 }
 
 /*****************************************************************************
  *
  * GateDelayWheel class:
- * Simple Delay event wheel
+ * Hierarchical timing wheel for the delay simulator
  *
  *****************************************************************************/
-void GateDelayWheel::insertEvent(Gate * gate) {
-    unsigned int wheel_space = current_event_queue + gate->getDelay();
-    if(wheel_space >= scheduled_events.size()) {
-        wheel_space = wheel_space - scheduled_events.size();
+const unsigned int GateDelayWheel::NO_EVENT;
+
+GateDelayWheel::GateDelayWheel() : free_list(NO_EVENT), current_time(0), current_value(LogicValue::X), num_events(0) {
+    for(unsigned int level = 0; level < DELAY_WHEEL_LEVELS; level++) {
+        occupied[level] = 0;
+        for(unsigned int slot = 0; slot < DELAY_WHEEL_SLOTS; slot++) {
+            head[level][slot] = NO_EVENT;
+            tail[level][slot] = NO_EVENT;
+        }
     }
-    scheduled_events.at(wheel_space).push(gate);
 }
 
-Gate * GateDelayWheel::getNextScheduled() {
-    unsigned int start_position = current_event_queue;
-    while(scheduled_events.at(current_event_queue).size() == 0) {
-        
-        current_event_queue++;
-        current_time_ns++;
-        if(current_event_queue >= scheduled_events.size()) {
-            current_event_queue -= scheduled_events.size();
+//appends the event to its slot for the current time
+void GateDelayWheel::link(unsigned int event) {
+    uint64_t diff = events[event].time ^ current_time;
+    unsigned int level = diff ? (63 - __builtin_clzll(diff)) / DELAY_WHEEL_BITS : 0;
+    unsigned int slot = (events[event].time >> (level * DELAY_WHEEL_BITS)) & (DELAY_WHEEL_SLOTS - 1);
+    events[event].next = NO_EVENT;
+    if(head[level][slot] == NO_EVENT) {
+        head[level][slot] = event;
+        occupied[level] |= (uint64_t(1) << slot);
+    } else {
+        events[tail[level][slot]].next = event;
+    }
+    tail[level][slot] = event;
+}
+
+void GateDelayWheel::release(unsigned int event) {
+    events[event].next = free_list;
+    free_list = event;
+}
+
+unsigned int GateDelayWheel::insertEvent(unsigned int gate, uint64_t delay, LogicValue value) {
+    unsigned int event = free_list;
+    if(event == NO_EVENT) {
+        event = events.size();
+        events.push_back(Event());
+    } else {
+        free_list = events[event].next;
+    }
+    events[event].time = current_time + delay;
+    events[event].gate = gate;
+    events[event].value = value;
+    link(event);
+    num_events++;
+    return event;
+}
+
+//moves the current time to the first non-empty slot of the lowest occupied level above 0 and
+//redistributes that slot's events onto the lower levels, until level 0 has events. Returns false
+//if the wheel is empty.
+bool GateDelayWheel::advance() {
+    while(occupied[0] == 0) {
+        unsigned int level = 1;
+        while(level < DELAY_WHEEL_LEVELS && occupied[level] == 0) {
+            level++;
+        }
+        if(level == DELAY_WHEEL_LEVELS) {
+            return false;
+        }
+        unsigned int slot = __builtin_ctzll(occupied[level]);
+        unsigned int shift = level * DELAY_WHEEL_BITS;
+        uint64_t upper = (shift + DELAY_WHEEL_BITS >= 64) ? 0 : (current_time >> (shift + DELAY_WHEEL_BITS)) << (shift + DELAY_WHEEL_BITS);
+        current_time = upper | (uint64_t(slot) << shift);
+
+        unsigned int event = head[level][slot];
+        head[level][slot] = NO_EVENT;
+        tail[level][slot] = NO_EVENT;
+        occupied[level] &= ~(uint64_t(1) << slot);
+        while(event != NO_EVENT) {
+            unsigned int next = events[event].next;
+            if(events[event].gate == NO_EVENT) { //cancelled
+                release(event);
+            } else {
+                link(event);
+            }
+            event = next;
+        }
+    }
+    return true;
+}
+
+unsigned int GateDelayWheel::getNextScheduled() {
+    while(true) {
+        if(occupied[0] == 0 && !advance()) {
+            return NO_EVENT;
+        }
+        unsigned int slot = __builtin_ctzll(occupied[0]);
+        unsigned int event = head[0][slot];
+        head[0][slot] = events[event].next;
+        if(head[0][slot] == NO_EVENT) {
+            tail[0][slot] = NO_EVENT;
+            occupied[0] &= ~(uint64_t(1) << slot);
         }
-        
-        if(start_position == current_event_queue) {
-            current_event_queue = 0;
-            return NULL;
+        release(event);
+        if(events[event].gate == NO_EVENT) { //cancelled
+            continue;
         }
+        current_time = events[event].time;
+        current_value = events[event].value;
+        num_events--;
+        return events[event].gate;
     }
-    
-    Gate * ret = scheduled_events.at(current_event_queue).front();
-    scheduled_events.at(current_event_queue).pop();
-    return ret;
-}
\ No newline at end of file
+}
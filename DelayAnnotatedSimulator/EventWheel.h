@@ -27,43 +27,91 @@
 
 #include <cstdlib>
 #include <vector>
-#include <queue>
-#include <set>
-#include <list>
+#include <cstdint>
 #include "Gates.h"
 #include "Type.h"
 #include <iostream>
 
 //base zero delay eventwheel, uses levels.
-//TODO: Inherit to make delay
+//events are gate indices (gate_id - 1).
+//Each level is a ring buffer in one flat array, sized by the number of gates on the level (a gate
+//is queued at most once). A bitmap of non-empty levels finds the next level with find first set.
 class EventWheel {
 protected:
-    //for now no delay annotation, just logic simulator
-    //list of scheduled events
-    std::vector< std::queue<Gate *, std::deque<Gate*> > > scheduled_events;
-    std::set<Gate *> scheduled_set;
+    std::vector<unsigned int> ring;        //level l owns ring[level_start[l]] .. ring[level_start[l+1]-1]
+    std::vector<unsigned int> level_start;
+    std::vector<unsigned int> level_head;  //offset of the oldest event in the level's ring
+    std::vector<unsigned int> level_count;
+    std::vector<uint64_t> occupied;        //bit l set when level l has events
+    std::vector<bool> scheduled;
     unsigned int current_event_queue;
 
+    inline void markOccupied(unsigned int level) {
+        occupied[level >> 6] |= (uint64_t(1) << (level & 63));
+    }
+    inline void markEmpty(unsigned int level) {
+        occupied[level >> 6] &= ~(uint64_t(1) << (level & 63));
+    }
+    unsigned int nextOccupied(unsigned int level) const; //first non-empty level >= level, NO_EVENT if none
 public:
+    static const unsigned int NO_EVENT = 0xFFFFFFFF;
     EventWheel() : current_event_queue(0) {}
-    EventWheel(unsigned int num_levels) : current_event_queue(0) {
-        scheduled_events.resize(num_levels);
-    }
+    //level_sizes[l] is the most events level l can hold at once, normally its gate count
+    EventWheel(const std::vector<unsigned int>& level_sizes, size_t num_gates);
     virtual ~EventWheel() {}
-    virtual void insertEvent(Gate *);
-    virtual Gate * getNextScheduled();
-    void clearWheel();
+    virtual void insertEvent(unsigned int gate, unsigned int level);
+    virtual unsigned int getNextScheduled(); //returns NO_EVENT when the round is done
 };
 
-class GateDelayWheel : EventWheel {
+//timing wheel for the delay simulator, events carry 64 bit absolute times.
+//Level k has DELAY_WHEEL_SLOTS slots of DELAY_WHEEL_SLOTS^k time units. An event sits on the level of the
+//highest bit where its time differs from the current time and moves down when the current time reaches
+//its slot, so delays of any size fit and insertion is O(1). Events of the same time come out in the
+//order they were inserted. insertEvent returns a handle that can cancel the event until it is returned.
+#define DELAY_WHEEL_BITS 6
+#define DELAY_WHEEL_SLOTS (1 << DELAY_WHEEL_BITS)
+#define DELAY_WHEEL_LEVELS ((64 + DELAY_WHEEL_BITS - 1) / DELAY_WHEEL_BITS)
+
+class GateDelayWheel {
 private:
-    unsigned int current_time_ns; //used to track the time taken this cycle, so each gates completion time can be annotated.
+    struct Event {
+        uint64_t time;
+        unsigned int gate; //NO_EVENT once cancelled
+        unsigned int next; //next event in the same slot
+        LogicValue value;
+    };
+    std::vector<Event> events; //event pool, free entries are chained from free_list
+    unsigned int free_list;
+    unsigned int head[DELAY_WHEEL_LEVELS][DELAY_WHEEL_SLOTS];
+    unsigned int tail[DELAY_WHEEL_LEVELS][DELAY_WHEEL_SLOTS];
+    uint64_t occupied[DELAY_WHEEL_LEVELS]; //bit s set when slot s of the level has events
+    uint64_t current_time;
+    LogicValue current_value;
+    size_t num_events;
+
+    void link(unsigned int event);
+    void release(unsigned int event);
+    bool advance();
 public:
-    GateDelayWheel(unsigned int max_delay) : current_time_ns(0) {
-        scheduled_events.resize(max_delay);
-    }
+    static const unsigned int NO_EVENT = 0xFFFFFFFF;
+    GateDelayWheel();
     ~GateDelayWheel() {}
-    void insertEvent(Gate *);
-    Gate * getNextScheduled();
+    //at current time + delay, value is handed back with the event
+    unsigned int insertEvent(unsigned int gate, uint64_t delay, LogicValue value = LogicValue::X);
+    inline void cancelEvent(unsigned int handle) {
+        events[handle].gate = NO_EVENT;
+        num_events--;
+    }
+    unsigned int getNextScheduled(); //returns NO_EVENT when the wheel is empty
+    inline uint64_t getCurrentTime() const { //time of the last event returned
+        return current_time;
+    }
+    inline LogicValue getEventValue() const { //value of the last event returned
+        return current_value;
+    }
+    inline size_t size() const {
+        return num_events;
+    }
 };
+
 #endif
@@ -9,12 +9,12 @@
 #include "Fault.h"
 #include "Gates.h"
 
-void Fault::injectState(std::vector<Gate*> & injected){
+void Fault::injectState(FaultGroup & group, unsigned int slot, std::vector<Gate*> & injected){
     while(!stateStore.isEmpty()){
         LogicValue tmp;
         Gate * gate_tmp;
         stateStore.pop(gate_tmp, tmp);
-        gate_tmp->castDff()->injectStoredFault(this, tmp);
+        group.injectState(gate_tmp->getId(), slot, tmp);
         injected.push_back(gate_tmp);
     }
 }
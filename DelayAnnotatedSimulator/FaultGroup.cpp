@@ -0,0 +1,68 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "FaultGroup.h"
+#include "Fault.h"
+#include <iostream>
+
+const unsigned int FaultGroup::NO_SLOT;
+
+FaultGroup::FaultGroup(unsigned int width, size_t num_gates) : num_words(width / PackedLogicValue::NUM_PATTERNS) {
+    if(width == 0 || width % PackedLogicValue::NUM_PATTERNS != 0) {
+        std::cerr << "INVALID FAULT GROUP WIDTH: " << width << std::endl;
+        exit(-1);
+    }
+    //gate ids start at 1, entry 0 is unused. Gates the faulty machine never computes (tie, mux and
+    //tristate) keep X in their planes.
+    planes.assign((num_gates + 1) * num_words, PackedLogicValue());
+    valid.assign((num_gates + 1) * num_words, 0);
+    site_head.assign(num_gates + 1, NO_SLOT);
+    site_next.assign(width, NO_SLOT);
+    detected.assign(num_words, 0);
+    is_touched.assign(num_gates + 1, false);
+    faults.reserve(width);
+}
+
+unsigned int FaultGroup::addFault(Fault * flt) {
+    unsigned int slot = faults.size();
+    unsigned int gate_id = flt->faultGateId();
+    faults.push_back(flt);
+    site_next[slot] = site_head[gate_id];
+    site_head[gate_id] = slot;
+    addValid(gate_id, slot >> 6, uint64_t(1) << (slot & 63));
+    return slot;
+}
+
+void FaultGroup::clear() {
+    for(unsigned int slot = 0; slot < faults.size(); slot++) {
+        site_head[faults[slot]->faultGateId()] = NO_SLOT;
+    }
+    faults.clear();
+    for(unsigned int i = 0; i < touched.size(); i++) {
+        std::fill(valid.begin() + touched[i] * num_words, valid.begin() + (touched[i] + 1) * num_words, 0);
+        is_touched[touched[i]] = false;
+    }
+    touched.clear();
+    std::fill(detected.begin(), detected.end(), 0);
+}
@@ -0,0 +1,133 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef DelayAnnotatedSimulator_FaultGroup_h
+#define DelayAnnotatedSimulator_FaultGroup_h
+
+#include <cstdlib>
+#include <vector>
+#include <cstdint>
+#include "Type.h"
+
+class Fault;
+
+#define FAULT_GROUP_WIDTH_DEFAULT 64
+
+//Faults simulated together in one faulty machine pass, one per slot. The width is a multiple of 64
+//set at runtime. Faulty values are dual-rail bit planes indexed by gate id: word w of a gate holds
+//slots 64w .. 64w+63, so one gate evaluation computes every fault of the group with word-wide ops.
+//A slot of a gate is valid once its fault reached the gate this pass, invalid slots read as the
+//good value.
+class FaultGroup {
+private:
+    unsigned int num_words;
+    std::vector<Fault *> faults;          //by slot
+    std::vector<PackedLogicValue> planes; //[gate_id * num_words + word]
+    std::vector<uint64_t> valid;          //same layout as planes
+    //slots whose fault sits on a gate, chained through site_next
+    std::vector<unsigned int> site_head;  //by gate id
+    std::vector<unsigned int> site_next;  //by slot
+    std::vector<uint64_t> detected;       //slots detected at a PO this pass, by word
+    //gates with valid slots, the only ones clear() has to reset
+    std::vector<unsigned int> touched;
+    std::vector<bool> is_touched;         //by gate id
+
+    inline void touch(unsigned int gate_id) {
+        if(!is_touched[gate_id]) {
+            is_touched[gate_id] = true;
+            touched.push_back(gate_id);
+        }
+    }
+public:
+    static const unsigned int NO_SLOT = 0xFFFFFFFF;
+
+    FaultGroup(unsigned int width, size_t num_gates);
+
+    inline unsigned int getWidth() const {
+        return num_words * PackedLogicValue::NUM_PATTERNS;
+    }
+    inline unsigned int getNumWords() const {
+        return num_words;
+    }
+    inline size_t size() const {
+        return faults.size();
+    }
+    inline bool isFull() const {
+        return faults.size() == getWidth();
+    }
+    inline Fault * getFault(unsigned int slot) const {
+        return faults[slot];
+    }
+
+    //puts the fault in the next free slot, valid at its gate, and returns the slot
+    unsigned int addFault(Fault * flt);
+    //faulty flip flop state carried over from the previous cycle
+    inline void injectState(unsigned int gate_id, unsigned int slot, LogicValue val) {
+        unsigned int idx = gate_id * num_words + (slot >> 6);
+        planes[idx].set(slot & 63, val);
+        valid[idx] |= (uint64_t(1) << (slot & 63));
+        touch(gate_id);
+    }
+    //removes every fault, all slots of all gates become invalid. Only visits the gates the group reached.
+    void clear();
+    inline size_t getNumTouched() const {
+        return touched.size();
+    }
+
+    //slots of the faults sitting on a gate
+    inline unsigned int firstSite(unsigned int gate_id) const {
+        return site_head[gate_id];
+    }
+    inline unsigned int nextSite(unsigned int slot) const {
+        return site_next[slot];
+    }
+
+    inline uint64_t getValid(unsigned int gate_id, unsigned int word) const {
+        return valid[gate_id * num_words + word];
+    }
+    //slots in mask reached the gate
+    inline void addValid(unsigned int gate_id, unsigned int word, uint64_t mask) {
+        valid[gate_id * num_words + word] |= mask;
+        touch(gate_id);
+    }
+    //the simulator marks the faults detected once the pass is done
+    inline uint64_t & getDetected(unsigned int word) {
+        return detected[word];
+    }
+    inline void setFaulty(unsigned int gate_id, unsigned int word, PackedLogicValue val) {
+        planes[gate_id * num_words + word] = val;
+    }
+    inline PackedLogicValue getStored(unsigned int gate_id, unsigned int word) const {
+        return planes[gate_id * num_words + word];
+    }
+    //faulty values of a gate, good for the invalid slots
+    inline PackedLogicValue getFaulty(unsigned int gate_id, unsigned int word, LogicValue good) const {
+        uint64_t mask = valid[gate_id * num_words + word];
+        const PackedLogicValue& val = planes[gate_id * num_words + word];
+        PackedLogicValue good_val(good);
+        return PackedLogicValue((val.lo & mask) | (good_val.lo & ~mask), (val.hi & mask) | (good_val.hi & ~mask));
+    }
+};
+
+#endif
@@ -0,0 +1,347 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "FlatNetlist.h"
+#include "Circuit.h"
+#include "GateKernels.h"
+#include "GateLUT.h"
+#include <algorithm>
+
+const unsigned int FlatNetlist::NOT_RANKED;
+
+FlatNetlist::FlatNetlist(Circuit * ckt) : grouping_size(ckt->getGICGroupingSize()), num_levels(ckt->getNumLevels()), fanin_counting(false) {
+    size_t num_gates = ckt->getNumGates();
+    gate_ids = localityOrder(ckt);
+    indices.resize(num_gates + 1);
+    for(unsigned int i = 0; i < num_gates; i++) {
+        indices[gate_ids[i]] = i;
+    }
+
+    types.resize(num_gates);
+    levels.resize(num_gates);
+    delays.resize(2 * num_gates);
+    values.assign(num_gates, LogicValue::X);
+    toggles.assign(num_gates, 0);
+    luts.resize(num_gates);
+    lut_gic.resize(num_gates);
+    fanin_start.resize(num_gates + 1);
+    fanout_start.resize(num_gates + 1);
+    gic_start.resize(num_gates + 1);
+
+    unsigned int num_gic = 0;
+    for(unsigned int i = 0; i < num_gates; i++) {
+        Gate * gate = ckt->getGateById(gate_ids[i]);
+        types[i] = gate->type();
+        levels[i] = gate->getLevel();
+        delays[2 * i] = ckt->getRiseDelay(gate_ids[i]);
+        delays[2 * i + 1] = ckt->getFallDelay(gate_ids[i]);
+        luts[i] = gate->getLUT();
+        lut_gic[i] = gate->hasLUTGIC();
+
+        fanin_start[i] = fanin_list.size();
+        for(unsigned int j = 0; j < gate->getNumFanin(); j++) {
+            fanin_list.push_back(getIndex(gate->getFaninId(j)));
+        }
+        fanout_start[i] = fanout_list.size();
+        for(unsigned int j = 0; j < gate->getNumFanout(); j++) {
+            fanout_list.push_back(getIndex(gate->getFanoutId(j)));
+        }
+        gic_start[i] = num_gic;
+        num_gic += gate->getNumGICPts();
+    }
+    fanin_start[num_gates] = fanin_list.size();
+    fanout_start[num_gates] = fanout_list.size();
+    gic_start[num_gates] = num_gic;
+    gic_coverage.assign(num_gic, false);
+
+    std::vector<Gate*> ckt_inputs = ckt->getInputs();
+    for(unsigned int i = 0; i < ckt_inputs.size(); i++) {
+        inputs.push_back(getIndex(ckt_inputs[i]->getId()));
+    }
+    std::vector<Gate*> ckt_outputs = ckt->getOutputs();
+    for(unsigned int i = 0; i < ckt_outputs.size(); i++) {
+        outputs.push_back(getIndex(ckt_outputs[i]->getId()));
+    }
+    std::vector<Gate*> ckt_state = ckt->getStateVars();
+    for(unsigned int i = 0; i < ckt_state.size(); i++) {
+        state_vars.push_back(getIndex(ckt_state[i]->getId()));
+    }
+
+    buildRegions();
+
+    stateGICCoverage.resize((state_vars.size() + grouping_size - 1) / grouping_size);
+    for(unsigned int i = 0; i < stateGICCoverage.size(); i++) {
+        unsigned int group_width = grouping_size;
+        if((i + 1) * grouping_size > state_vars.size()) {
+            group_width = state_vars.size() % grouping_size;
+        }
+        stateGICCoverage[i].assign(0x01 << group_width, false);
+    }
+}
+
+//Gate ids sorted by level, and within a level by breadth first discovery order from the inputs
+//and state variables over fanout edges (Cuthill-McKee style). Gates the event wheel visits
+//together and the fanouts of one gate end up next to each other in the per gate arrays.
+std::vector<unsigned int> FlatNetlist::localityOrder(Circuit * ckt) {
+    size_t num_gates = ckt->getNumGates();
+    std::vector<unsigned int> rank(num_gates + 1, NOT_RANKED);
+    std::vector<unsigned int> frontier;
+    unsigned int next_rank = 0;
+
+    std::vector<Gate*> sources = ckt->getInputs();
+    std::vector<Gate*> ckt_state = ckt->getStateVars();
+    sources.insert(sources.end(), ckt_state.begin(), ckt_state.end());
+    for(unsigned int id = 1; id <= num_gates; id++) {
+        if(ckt->getGateById(id)->getNumFanin() == 0) { //tie cells
+            sources.push_back(ckt->getGateById(id));
+        }
+    }
+    for(unsigned int i = 0; i < sources.size(); i++) {
+        if(rank[sources[i]->getId()] == NOT_RANKED) {
+            rank[sources[i]->getId()] = next_rank++;
+            frontier.push_back(sources[i]->getId());
+        }
+    }
+    for(unsigned int head = 0; head < frontier.size(); head++) {
+        Gate * gate = ckt->getGateById(frontier[head]);
+        for(unsigned int j = 0; j < gate->getNumFanout(); j++) {
+            unsigned int fout = gate->getFanoutId(j);
+            if(rank[fout] == NOT_RANKED) {
+                rank[fout] = next_rank++;
+                frontier.push_back(fout);
+            }
+        }
+    }
+
+    std::vector<std::pair<std::pair<unsigned int, unsigned int>, unsigned int> > keyed(num_gates);
+    for(unsigned int id = 1; id <= num_gates; id++) {
+        unsigned int key = (rank[id] == NOT_RANKED) ? next_rank + id : rank[id]; //unreachable gates keep file order
+        keyed[id - 1] = std::make_pair(std::make_pair(ckt->getGateById(id)->getLevel(), key), id);
+    }
+    std::sort(keyed.begin(), keyed.end());
+    std::vector<unsigned int> order(num_gates);
+    for(unsigned int i = 0; i < num_gates; i++) {
+        order[i] = keyed[i].second;
+    }
+    return order;
+}
+
+//Indices are in level order and a fanout is always on a higher level than its driver, so walking
+//the indices backwards sees the root of a gate's fanout before the gate itself.
+void FlatNetlist::buildRegions() {
+    size_t num_gates = types.size();
+    region_root.resize(num_gates);
+    for(unsigned int i = num_gates; i-- > 0; ) {
+        region_root[i] = i;
+        if(types[i] == Gate::INPUT || types[i] == Gate::D_FF || GateKernels::isConstant(types[i]) || getNumFanout(i) != 1) {
+            continue;
+        }
+        unsigned int fout = *fanoutBegin(i);
+        if(types[fout] != Gate::D_FF) {
+            region_root[i] = region_root[fout];
+        }
+    }
+
+    region_start.assign(num_gates + 1, 0);
+    for(unsigned int i = 0; i < num_gates; i++) {
+        region_start[region_root[i] + 1]++;
+    }
+    for(unsigned int i = 0; i < num_gates; i++) {
+        region_start[i + 1] += region_start[i];
+    }
+    std::vector<unsigned int> fill(region_start.begin(), region_start.end() - 1);
+    region_list.resize(num_gates);
+    for(unsigned int i = 0; i < num_gates; i++) {
+        region_list[fill[region_root[i]]++] = i;
+    }
+}
+
+//output of the gate for the current fanin values, entry is the LUT entry when the gate has a LUT
+LogicValue FlatNetlist::computeValue(unsigned int gate, unsigned char gate_type, unsigned char & entry) const {
+    const unsigned char * table = luts[gate];
+    if(table) {
+        unsigned int idx = 0;
+        for(const unsigned int * fin = faninBegin(gate); fin != faninEnd(gate); ++fin) {
+            idx = (idx << 2) | values[*fin];
+        }
+        entry = table[idx];
+        return LogicValue::VALUES(entry & GateLUT::OUTPUT_MASK);
+    }
+    if(fanin_counting && GateKernels::isCounted(gate_type)) {
+        return countedValue(gate, gate_type);
+    }
+    unsigned int num_fanin = getNumFanin(gate);
+    return GateKernels::get(gate_type, num_fanin)(values.data(), faninBegin(gate), num_fanin);
+}
+
+LogicValue FlatNetlist::computeValue(unsigned int gate) const {
+    unsigned char entry = 0;
+    return computeValue(gate, types[gate], entry);
+}
+
+bool FlatNetlist::commitValue(unsigned int gate, LogicValue val) {
+    LogicValue previous = getValue(gate);
+    if(val == previous) {
+        return false;
+    }
+    setValue(gate, val);
+    updateToggle(gate, previous, val);
+    return true;
+}
+
+bool FlatNetlist::evaluate(unsigned int gate, bool calc_gic) {
+    unsigned char gate_type = types[gate];
+    if(gate_type == Gate::INPUT) {
+        //value was set by the simulator, always propagate
+        return true;
+    }
+
+    LogicValue previous = getValue(gate);
+    unsigned char entry = 0;
+    LogicValue val = computeValue(gate, gate_type, entry);
+    if(fanin_counting && val != previous) {
+        updateFaninCounts(gate, previous, val);
+    }
+    values[gate] = val.val;
+    if(GateKernels::isConstant(gate_type)) {
+        return false;
+    }
+
+    updateToggle(gate, previous, val);
+    if(calc_gic && GateKernels::hasGIC(gate_type)) {
+        if(!luts[gate] || !lut_gic[gate]) {
+            setGIC(gate);
+        } else if(entry & GateLUT::GIC_VALID) {
+            gic_coverage[gic_start[gate] + (entry >> GateLUT::GIC_SHIFT)] = true;
+        }
+    }
+    return val != previous;
+}
+
+//LogicValue & and | work on the code bits, so AND has a rail set only if every fanin has it
+//set and OR if any fanin has it set.
+LogicValue FlatNetlist::countedValue(unsigned int gate, unsigned char gate_type) const {
+    bool is_and = (gate_type == Gate::AND) || (gate_type == Gate::NAND);
+    unsigned int needed = is_and ? getNumFanin(gate) : 1;
+    unsigned int code = ((fanin_lo_count[gate] >= needed) ? 0x01 : 0x00) |
+                        ((fanin_hi_count[gate] >= needed) ? 0x02 : 0x00);
+    LogicValue val = LogicValue(LogicValue::VALUES(code));
+    return (gate_type == Gate::NAND || gate_type == Gate::NOR) ? ~val : val;
+}
+
+void FlatNetlist::setFaninCounting(bool enable) {
+    fanin_counting = enable;
+    if(!enable) {
+        return;
+    }
+    fanin_lo_count.assign(types.size(), 0);
+    fanin_hi_count.assign(types.size(), 0);
+    for(unsigned int i = 0; i < types.size(); i++) {
+        for(const unsigned int * fin = faninBegin(i); fin != faninEnd(i); ++fin) {
+            fanin_lo_count[i] += values[*fin] & 0x01;
+            fanin_hi_count[i] += values[*fin] >> 1;
+        }
+    }
+}
+
+void FlatNetlist::setGIC(unsigned int gate) {
+    unsigned int idx = 0;
+    for(const unsigned int * fin = faninBegin(gate); fin != faninEnd(gate); ++fin) {
+        if(types[*fin] == Gate::TIE_ZERO || types[*fin] == Gate::TIE_ONE) continue;
+        LogicValue val = getValue(*fin);
+        if(val == LogicValue::X || val == LogicValue::Z) {
+            return;
+        }
+        idx = (idx << 1) | ((val == LogicValue::ONE) ? 0x01 : 0x00);
+    }
+    gic_coverage[gic_start[gate] + idx] = true;
+}
+
+void FlatNetlist::setStateGIC() {
+    for(unsigned int group = 0; group < stateGICCoverage.size(); group++) {
+        unsigned int first = group * grouping_size;
+        unsigned int last = std::min<size_t>(first + grouping_size, state_vars.size());
+        unsigned int idx = 0x00;
+        bool has_X = false;
+        for(unsigned int i = first; i < last; i++) {
+            LogicValue val = getValue(state_vars[i]);
+            if(val == LogicValue::X) {
+                has_X = true;
+                break;
+            }
+            idx = (idx << 1) | ((val == LogicValue::ONE) ? 0x01 : 0x00);
+        }
+        if(!has_X) {
+            stateGICCoverage[group][idx] = true;
+        }
+    }
+}
+
+double FlatNetlist::calculateGIC() const {
+    unsigned int num_pts = 0;
+    unsigned int covered = 0;
+    for(unsigned int i = 0; i < types.size(); i++) {
+        if((types[i] != Gate::INPUT) &&
+           (types[i] != Gate::OUTPUT) &&
+           (types[i] != Gate::TIE_ONE) &&
+           (types[i] != Gate::TIE_Z) &&
+           (types[i] != Gate::TIE_X) &&
+           (types[i] != Gate::D_FF))
+        {
+            num_pts += gic_start[i+1] - gic_start[i];
+            for(unsigned int j = gic_start[i]; j < gic_start[i+1]; j++) {
+                if(gic_coverage[j]) {
+                    covered++;
+                }
+            }
+        }
+    }
+
+    for(unsigned int i = 0; i < stateGICCoverage.size(); i++) {
+        num_pts += stateGICCoverage[i].size();
+        for(unsigned int j = 0; j < stateGICCoverage[i].size(); j++) {
+            if(stateGICCoverage[i][j]) {
+                covered++;
+            }
+        }
+    }
+    return (double) covered / ((double) num_pts);
+}
+
+double FlatNetlist::calculateToggle() const {
+    unsigned int num_no_cov = 0;
+    unsigned int num_toggle = 0;
+    for(unsigned int i = 0; i < types.size(); i++) {
+        if((types[i] == Gate::INPUT) ||
+           (types[i] == Gate::TIE_ONE) ||
+           (types[i] == Gate::TIE_Z) ||
+           (types[i] == Gate::TIE_X))
+        {
+            num_no_cov++;
+        } else {
+            num_toggle += ((toggles[i] & TOGGLED_UP) ? 1 : 0) + ((toggles[i] & TOGGLED_DOWN) ? 1 : 0);
+        }
+    }
+    return ((double) num_toggle) / (((double) (types.size() - num_no_cov)) * 2);
+}
@@ -0,0 +1,229 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef __DelayAnnotatedSimulator__FlatNetlist__
+#define __DelayAnnotatedSimulator__FlatNetlist__
+
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "Gates.h"
+#include "Type.h"
+
+class Circuit;
+
+//Structure of arrays copy of a Circuit used by the simulators.
+//Gates are addressed by index, which is not the gate id: gates are renumbered for locality
+//(see localityOrder) and getIndex/getGateId map between the two. Fanin and fanout are stored CSR style:
+//the fanins of gate g are fanin_list[fanin_start[g]] .. fanin_list[fanin_start[g+1]-1].
+class FlatNetlist {
+private:
+    static const unsigned int NOT_RANKED = 0xFFFFFFFF;
+
+    //index <-> gate id remap
+    std::vector<unsigned int> gate_ids; //by index
+    std::vector<unsigned int> indices;  //by gate id, entry 0 unused
+
+    //per gate arrays
+    std::vector<unsigned char> types;
+    std::vector<unsigned int> levels;
+    std::vector<unsigned int> delays;   //rise delay of gate g at [2 * g], fall delay at [2 * g + 1]
+    std::vector<unsigned char> values;  //LogicValue::VALUES
+    std::vector<unsigned char> toggles; //TOGGLED_UP | TOGGLED_DOWN
+    std::vector<const unsigned char *> luts; //GateLUT of the gate, NULL if it has none
+    std::vector<bool> lut_gic;               //LUT GIC slot is the gate's slot (no tie fanins)
+
+    //adjacency
+    std::vector<unsigned int> fanin_start;
+    std::vector<unsigned int> fanin_list;
+    std::vector<unsigned int> fanout_start;
+    std::vector<unsigned int> fanout_list;
+
+    //gate input combination coverage, gate g owns gic_coverage[gic_start[g]] .. gic_coverage[gic_start[g+1]-1]
+    std::vector<unsigned int> gic_start;
+    std::vector<bool> gic_coverage;
+    std::vector<std::vector<bool> > stateGICCoverage;
+    unsigned int grouping_size;
+
+    std::vector<unsigned int> inputs;
+    std::vector<unsigned int> outputs;
+    std::vector<unsigned int> state_vars;
+    unsigned int num_levels;
+
+    //fanout free regions. A gate whose only fanout is a combinational gate is evaluated as part of the
+    //region of that fanout. Members of the region rooted at r, in level order ending with r, are
+    //region_list[region_start[r]] .. region_list[region_start[r+1]-1]; non-roots own no members.
+    std::vector<unsigned int> region_root;
+    std::vector<unsigned int> region_start;
+    std::vector<unsigned int> region_list;
+
+    //fanin counting: number of fanin connections of each gate with the lo/hi rail of their value
+    //code set. AND/NAND/OR/NOR outputs follow from these without reading the fanins.
+    bool fanin_counting;
+    std::vector<unsigned int> fanin_lo_count;
+    std::vector<unsigned int> fanin_hi_count;
+
+    static std::vector<unsigned int> localityOrder(Circuit * ckt);
+    void buildRegions();
+    void setGIC(unsigned int gate);
+    LogicValue countedValue(unsigned int gate, unsigned char gate_type) const;
+    LogicValue computeValue(unsigned int gate, unsigned char gate_type, unsigned char & entry) const;
+    inline void updateFaninCounts(unsigned int gate, LogicValue previous, LogicValue current) {
+        int lo_delta = int(current.val & 0x01) - int(previous.val & 0x01);
+        int hi_delta = int(current.val >> 1) - int(previous.val >> 1);
+        for(const unsigned int * fout = fanoutBegin(gate); fout != fanoutEnd(gate); ++fout) {
+            fanin_lo_count[*fout] += lo_delta;
+            fanin_hi_count[*fout] += hi_delta;
+        }
+    }
+    inline void updateToggle(unsigned int gate, LogicValue previous, LogicValue current) {
+        if((previous == LogicValue::ZERO) && (current == LogicValue::ONE)) {
+            toggles[gate] |= TOGGLED_UP;
+        }
+        if((previous == LogicValue::ONE) && (current == LogicValue::ZERO)) {
+            toggles[gate] |= TOGGLED_DOWN;
+        }
+    }
+
+public:
+    enum {
+        TOGGLED_UP = 0x01,
+        TOGGLED_DOWN = 0x02
+    };
+
+    FlatNetlist(Circuit * ckt);
+
+    //evaluates gate from the current fanin values, returns true if the output changed.
+    bool evaluate(unsigned int gate, bool calc_gic);
+    //split evaluation for simulators that apply an output later than they compute it: computeValue
+    //leaves the gate untouched, commitValue sets an output (with toggle tracking) and returns true if it changed.
+    LogicValue computeValue(unsigned int gate) const;
+    bool commitValue(unsigned int gate, LogicValue val);
+
+    inline size_t getNumGates() const {
+        return types.size();
+    }
+    inline unsigned int getGateId(unsigned int gate) const {
+        return gate_ids[gate];
+    }
+    inline unsigned int getIndex(unsigned int gate_id) const {
+        return indices[gate_id];
+    }
+    inline unsigned int getNumLevels() const {
+        return num_levels;
+    }
+    inline Gate::GateType type(unsigned int gate) const {
+        return Gate::GateType(types[gate]);
+    }
+    inline unsigned int getLevel(unsigned int gate) const {
+        return levels[gate];
+    }
+    //delay of a change of the gate's output to val, changes to X or Z take the shorter one
+    inline unsigned int getDelay(unsigned int gate, LogicValue val) const {
+        if(val == LogicValue::ONE) {
+            return delays[2 * gate];
+        }
+        if(val == LogicValue::ZERO) {
+            return delays[2 * gate + 1];
+        }
+        return std::min(delays[2 * gate], delays[2 * gate + 1]);
+    }
+    inline LogicValue getValue(unsigned int gate) const {
+        return LogicValue(LogicValue::VALUES(values[gate]));
+    }
+    inline void setValue(unsigned int gate, LogicValue val) {
+        if(fanin_counting) {
+            updateFaninCounts(gate, getValue(gate), val);
+        }
+        values[gate] = val.val;
+    }
+
+    //AND/NAND/OR/NOR without a LUT (wider than LUT_MAX_FANIN) evaluate from fanin counts kept up to date on every value change,
+    //O(1) per evaluation instead of O(fanin). Counts are rebuilt from the current values when enabled.
+    void setFaninCounting(bool enable);
+    inline bool isFaninCounting() const {
+        return fanin_counting;
+    }
+
+    inline unsigned int getNumFanin(unsigned int gate) const {
+        return fanin_start[gate+1] - fanin_start[gate];
+    }
+    inline unsigned int getFanin(unsigned int gate, unsigned int idx) const {
+        return fanin_list[fanin_start[gate] + idx];
+    }
+    inline const unsigned int * faninBegin(unsigned int gate) const {
+        return fanin_list.data() + fanin_start[gate];
+    }
+    inline const unsigned int * faninEnd(unsigned int gate) const {
+        return fanin_list.data() + fanin_start[gate+1];
+    }
+    inline unsigned int getRegionRoot(unsigned int gate) const {
+        return region_root[gate];
+    }
+    inline const unsigned int * regionBegin(unsigned int root) const {
+        return region_list.data() + region_start[root];
+    }
+    inline const unsigned int * regionEnd(unsigned int root) const {
+        return region_list.data() + region_start[root+1];
+    }
+
+    inline unsigned int getNumFanout(unsigned int gate) const {
+        return fanout_start[gate+1] - fanout_start[gate];
+    }
+    inline const unsigned int * fanoutBegin(unsigned int gate) const {
+        return fanout_list.data() + fanout_start[gate];
+    }
+    inline const unsigned int * fanoutEnd(unsigned int gate) const {
+        return fanout_list.data() + fanout_start[gate+1];
+    }
+
+    inline size_t getNumInput() const {
+        return inputs.size();
+    }
+    inline size_t getNumOutput() const {
+        return outputs.size();
+    }
+    inline size_t getNumStateVar() const {
+        return state_vars.size();
+    }
+    inline unsigned int getInput(unsigned int idx) const {
+        return inputs[idx];
+    }
+    inline unsigned int getOutput(unsigned int idx) const {
+        return outputs[idx];
+    }
+    inline unsigned int getStateVar(unsigned int idx) const {
+        return state_vars[idx];
+    }
+    inline unsigned int getGlobalReset() const { //same gate as Circuit::global_reset
+        return inputs.back();
+    }
+
+    //coverage metrics, same definitions as the Circuit versions
+    void setStateGIC();
+    double calculateGIC() const;
+    double calculateToggle() const;
+};
+
+#endif /* defined(__DelayAnnotatedSimulator__FlatNetlist__) */
@@ -0,0 +1,72 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "GateKernels.h"
+
+#define REDUCE_ROW(OP, INVERT) { &reduce<OP, INVERT, 0>, &reduce<OP, INVERT, 1>, &reduce<OP, INVERT, 2>, \
+                                 &reduce<OP, INVERT, 3>, &reduce<OP, INVERT, 4> }
+#define SINGLE_ROW(KERNEL) { KERNEL, KERNEL, KERNEL, KERNEL, KERNEL }
+
+//rows follow the order of Gate::GateType
+const EvalKernel GateKernels::kernel_table[NUM_GATE_TYPES][KERNEL_MAX_SPECIALIZED_FANIN + 1] = {
+    SINGLE_ROW(&constant<LogicValue::X>),    //NONE
+    SINGLE_ROW(NULL),                        //INPUT, value is set by the simulator
+    SINGLE_ROW(&buffer),                     //OUTPUT
+    REDUCE_ROW(AndOp, false),                //AND
+    REDUCE_ROW(AndOp, true),                 //NAND
+    REDUCE_ROW(OrOp, false),                 //OR
+    REDUCE_ROW(OrOp, true),                  //NOR
+    SINGLE_ROW(&invert),                     //NOT
+    REDUCE_ROW(XorOp, false),                //XOR
+    REDUCE_ROW(XorOp, true),                 //XNOR
+    SINGLE_ROW(&constant<LogicValue::ZERO>), //TIE_ZERO
+    SINGLE_ROW(&constant<LogicValue::ONE>),  //TIE_ONE
+    SINGLE_ROW(&constant<LogicValue::X>),    //TIE_X
+    SINGLE_ROW(&constant<LogicValue::Z>),    //TIE_Z
+    SINGLE_ROW(&buffer),                     //BUF
+    SINGLE_ROW(&mux2),                       //MUX_2
+    SINGLE_ROW(&tristate),                   //TRISTATE
+    SINGLE_ROW(&buffer)                      //D_FF
+};
+
+const unsigned char GateKernels::type_flags[NUM_GATE_TYPES] = {
+    0,                 //NONE
+    0,                 //INPUT
+    0,                 //OUTPUT
+    HAS_GIC | COUNTED, //AND
+    HAS_GIC | COUNTED, //NAND
+    HAS_GIC | COUNTED, //OR
+    HAS_GIC | COUNTED, //NOR
+    HAS_GIC,           //NOT
+    HAS_GIC,           //XOR
+    HAS_GIC,           //XNOR
+    CONSTANT,          //TIE_ZERO
+    CONSTANT,          //TIE_ONE
+    CONSTANT,          //TIE_X
+    CONSTANT,          //TIE_Z
+    HAS_GIC,           //BUF
+    HAS_GIC,           //MUX_2
+    0,                 //TRISTATE
+    0                  //D_FF
+};
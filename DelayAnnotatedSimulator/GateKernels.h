@@ -0,0 +1,118 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef DelayAnnotatedSimulator_GateKernels_h
+#define DelayAnnotatedSimulator_GateKernels_h
+
+#include "Gates.h"
+#include "Type.h"
+
+//Evaluation kernels for the FlatNetlist. A kernel only computes the new output value of a gate
+//from the value array; dirty/toggle/GIC bookkeeping is done once in FlatNetlist::evaluate.
+typedef LogicValue (*EvalKernel)(const unsigned char * values, const unsigned int * fin, unsigned int num_fanin);
+
+#define KERNEL_MAX_SPECIALIZED_FANIN 4
+#define NUM_GATE_TYPES (Gate::D_FF + 1)
+
+class GateKernels {
+private:
+    //indexed by [type][num_fanin], column 0 holds the generic kernel for wider gates
+    static const EvalKernel kernel_table[NUM_GATE_TYPES][KERNEL_MAX_SPECIALIZED_FANIN + 1];
+    static const unsigned char type_flags[NUM_GATE_TYPES];
+
+    /********************************************************/
+    // kernel building blocks
+    /********************************************************/
+    static inline LogicValue value(const unsigned char * values, unsigned int gate) {
+        return LogicValue(LogicValue::VALUES(values[gate]));
+    }
+
+    struct AndOp {
+        static inline LogicValue apply(LogicValue lhs, LogicValue rhs) { return lhs & rhs; }
+    };
+    struct OrOp {
+        static inline LogicValue apply(LogicValue lhs, LogicValue rhs) { return lhs | rhs; }
+    };
+    struct XorOp {
+        static inline LogicValue apply(LogicValue lhs, LogicValue rhs) { return lhs ^ rhs; }
+    };
+
+    //N is the fanin count when known at compile time (loop is unrolled), 0 for the generic width.
+    template <class Op, bool INVERT, unsigned int N>
+    static LogicValue reduce(const unsigned char * values, const unsigned int * fin, unsigned int num_fanin) {
+        const unsigned int width = N ? N : num_fanin;
+        LogicValue val = value(values, fin[0]);
+        for(unsigned int i = 1; i < width; i++) {
+            val = Op::apply(val, value(values, fin[i]));
+        }
+        return INVERT ? ~val : val;
+    }
+
+    template <LogicValue::VALUES V>
+    static LogicValue constant(const unsigned char *, const unsigned int *, unsigned int) {
+        return LogicValue(V);
+    }
+
+    static LogicValue buffer(const unsigned char * values, const unsigned int * fin, unsigned int) {
+        return value(values, fin[0]);
+    }
+
+    static LogicValue invert(const unsigned char * values, const unsigned int * fin, unsigned int) {
+        return ~value(values, fin[0]);
+    }
+
+    static LogicValue mux2(const unsigned char * values, const unsigned int * fin, unsigned int) {
+        LogicValue sel = value(values, fin[0]);
+        if(sel == LogicValue::Z || sel == LogicValue::X) {
+            return LogicValue::X;
+        }
+        return (sel == LogicValue::ONE) ? value(values, fin[2]) : value(values, fin[1]);
+    }
+
+    static LogicValue tristate(const unsigned char * values, const unsigned int * fin, unsigned int) {
+        return (value(values, fin[1]) == LogicValue::ZERO) ? value(values, fin[0]) : LogicValue(LogicValue::Z);
+    }
+
+public:
+    enum {
+        HAS_GIC = 0x01,  //gate records GIC coverage on evaluation
+        CONSTANT = 0x02, //tie cell, never reports a change
+        COUNTED = 0x04   //AND/NAND/OR/NOR, output follows from the number of fanins with each rail set
+    };
+
+    static inline EvalKernel get(unsigned int type, unsigned int num_fanin) {
+        return kernel_table[type][(num_fanin <= KERNEL_MAX_SPECIALIZED_FANIN) ? num_fanin : 0];
+    }
+    static inline bool hasGIC(unsigned int type) {
+        return (type_flags[type] & HAS_GIC) != 0;
+    }
+    static inline bool isConstant(unsigned int type) {
+        return (type_flags[type] & CONSTANT) != 0;
+    }
+    static inline bool isCounted(unsigned int type) {
+        return (type_flags[type] & COUNTED) != 0;
+    }
+};
+
+#endif
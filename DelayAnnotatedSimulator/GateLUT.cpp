@@ -0,0 +1,50 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "GateLUT.h"
+#include "GateKernels.h"
+
+GateLUT::GateLUT(unsigned int type, unsigned int num_fanin) {
+    EvalKernel kernel = GateKernels::get(type, num_fanin);
+    unsigned int fin[LUT_MAX_FANIN];
+    unsigned char codes[LUT_MAX_FANIN];
+    for(unsigned int i = 0; i < num_fanin; i++) {
+        fin[i] = i;
+    }
+
+    entries.resize(0x01 << (2 * num_fanin));
+    for(unsigned int idx = 0; idx < entries.size(); idx++) {
+        bool gic_valid = true;
+        unsigned int gic = 0;
+        for(unsigned int i = 0; i < num_fanin; i++) {
+            codes[i] = (idx >> (2 * (num_fanin - 1 - i))) & 0x03;
+            gic_valid = gic_valid && (codes[i] == LogicValue::ZERO || codes[i] == LogicValue::ONE);
+            gic = (gic << 1) | ((codes[i] == LogicValue::ONE) ? 0x01 : 0x00);
+        }
+        entries[idx] = kernel(codes, fin, num_fanin).val;
+        if(gic_valid) {
+            entries[idx] |= GIC_VALID | (gic << GIC_SHIFT);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef DelayAnnotatedSimulator_GateLUT_h
+#define DelayAnnotatedSimulator_GateLUT_h
+
+#include <vector>
+
+#define LUT_MAX_FANIN 4
+
+//Truth table for one gate type and fanin count. The index packs the 2 bit LogicValue codes of
+//the fanins, first fanin most significant: idx = (idx << 2) | code. Each entry holds the output
+//code and, when every fanin is ZERO or ONE, the GIC slot setGIC would compute for that combination.
+class GateLUT {
+private:
+    std::vector<unsigned char> entries;
+public:
+    enum {
+        OUTPUT_MASK = 0x03,
+        GIC_VALID = 0x04,
+        GIC_SHIFT = 3
+    };
+
+    GateLUT(unsigned int type, unsigned int num_fanin);
+
+    inline const unsigned char * data() const {
+        return entries.data();
+    }
+};
+
+#endif
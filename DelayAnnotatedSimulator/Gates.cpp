@@ -23,6 +23,7 @@ THE SOFTWARE.
 */
 
 #include "Gates.h"
+#include "GateLUT.h"
 #include <iostream>
 
 unsigned short Gate::fault_round = 0;
@@ -36,30 +37,94 @@ void Gate::evaluate() {
     output = LogicValue::X;
 }
 
-const std::vector<Gate*>& Gate::getFanin() {
+void Gate::evaluateLUT() {
+    LogicValue previous = output;
+    unsigned int idx = 0;
+    for(unsigned int i = 0; i < fanin.size(); i++) {
+        idx = (idx << 2) | getFanin(i)->getOut().val;
+    }
+    unsigned char entry = lut[idx];
+    output = LogicValue::VALUES(entry & GateLUT::OUTPUT_MASK);
+    commitOutput(previous);
+    if(!lut_gic) {
+        setGIC();
+    } else if(calc_GIC && (entry & GateLUT::GIC_VALID)) {
+        GIC_coverage[entry >> GateLUT::GIC_SHIFT] = true;
+    }
+}
+
+const GateList& Gate::getFanin() {
     return fanin;
 }
 
-const std::vector<Gate*>& Gate::getFanout() {
+const GateList& Gate::getFanout() {
     return fanout;
 }
 
+void Gate::replaceFanin(Gate * from, Gate * to) {
+    for(unsigned int i = 0; i < fanin.size(); i++) {
+        if(fanin[i] == from->gate_id) {
+            fanin[i] = to->gate_id;
+        }
+    }
+}
 
-//diverges and creates faulty copies for all fanouts.
-inline void Gate::diverge(Fault* flt) {
+void Gate::replaceFanout(Gate * from, Gate * to) {
+    for(unsigned int i = 0; i < fanout.size(); i++) {
+        if(fanout[i] == from->gate_id) {
+            fanout[i] = to->gate_id;
+        }
+    }
+}
+
+void Gate::removeFanout(Gate * gate) {
+    for(unsigned int i = 0; i < fanout.size(); i++) {
+        if(fanout[i] == gate->gate_id) {
+            fanout.erase(fanout.begin() + i);
+            return;
+        }
+    }
+}
+
+void Gate::renumberAdjacency(const std::vector<unsigned int>& new_id) {
+    for(unsigned int i = 0; i < fanin.size(); i++) {
+        fanin[i] = new_id[fanin[i]];
+    }
+    for(unsigned int i = 0; i < fanout.size(); i++) {
+        fanout[i] = new_id[fanout[i]];
+    }
+}
+
+
+//diverges and creates faulty copies for all fanouts, flip flops store the faulty value for the next cycle.
+void Gate::diverge(FaultGroup & group, unsigned int word, uint64_t diverged, PackedLogicValue val) {
     for(unsigned int i = 0; i<fanout.size(); i++){
-        if(fanout[i]->type() != Gate::D_FF){
-            fanout[i]->addFault(flt);
-        } else {
-            flt->storeState(fanout[i], f_vals[flt->getFID() % NUM_FAULT_INJECT]);
+        if(getFanout(i)->type() != Gate::D_FF){
+            group.addValid(fanout[i], word, diverged);
+            continue;
+        }
+        for(uint64_t rest = diverged; rest; rest &= rest - 1) {
+            unsigned int bit = __builtin_ctzll(rest);
+            group.getFault((word << 6) + bit)->storeState(getFanout(i), val.get(bit));
         }
     }
 }
 
-void Gate::clearFaultValid(){
-    for(int i = 0; i<NUM_FAULT_INJECT; i++){
-        valid[i] = false;
+//applies the output stuck at faults of this gate, stores the valid slots and diverges the ones that
+//differ from the good value. Returns true if any did.
+bool Gate::commitFaulty(FaultGroup & group, unsigned int word, PackedLogicValue val) {
+    for(unsigned int slot = group.firstSite(gate_id); slot != FaultGroup::NO_SLOT; slot = group.nextSite(slot)) {
+        if((slot >> 6) == word && group.getFault(slot)->faultGateNet() == 0) {
+            val.set(slot & 63, group.getFault(slot)->faultSA());
+        }
     }
+    group.setFaulty(gate_id, word, val);
+    PackedLogicValue good(output);
+    uint64_t diverged = group.getValid(gate_id, word) & ((val.lo ^ good.lo) | (val.hi ^ good.hi));
+    if(diverged) {
+        diverge(group, word, diverged, val);
+    }
+    return diverged != 0;
 }
 
 /********************************************************/
@@ -69,42 +134,28 @@ void Gate::clearFaultValid(){
 void AndGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    LogicValue val = fanin[0]->getOut();
+    LogicValue val = getFanin(0)->getOut();
     for(unsigned int i = 1; i<fanin.size(); i++) {
-        val = val & fanin[i]->getOut();
+        val = val & getFanin(i)->getOut();
     }
     output = val;
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    commitOutput(previous);
     setGIC();
 }
 
-void AndGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for( unsigned int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
+bool AndGate::faultEvaluate(FaultGroup & group) {
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(!group.getValid(gate_id, word)) {
             continue;
         }
-        LogicValue fval = LogicValue::ONE;
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        
-        for( unsigned int inputs = 0; inputs < fanin.size(); inputs++ ){
-            fval &= (injection_site && (assoc_faults[i]->faultGateNet()-1 == inputs))
-            ? assoc_faults[i]->faultSA() : fanin[inputs]->getFaultyValue(assoc_faults[i]);
-        }
-        f_vals[i] = (injection_site && (assoc_faults[i]->faultGateNet() == 0)) ? assoc_faults[i]->faultSA() : fval;
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+        PackedLogicValue fval = faultyFanin(group, 0, word);
+        for(unsigned int i = 1; i < fanin.size(); i++) {
+            fval = fval & faultyFanin(group, i, word);
         }
+        diverged |= commitFaulty(group, word, fval);
     }
+    return diverged;
 }
 
 
@@ -115,42 +166,28 @@ void AndGate::faultEvaluate(){
 void NandGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    LogicValue val = fanin[0]->getOut();
+    LogicValue val = getFanin(0)->getOut();
     for(unsigned int i = 1; i<fanin.size(); i++) {
-        val = val & fanin[i]->getOut();
+        val = val & getFanin(i)->getOut();
     }
     output = ~val;
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    commitOutput(previous);
     setGIC();
 }
 
-void NandGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for( unsigned int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
+bool NandGate::faultEvaluate(FaultGroup & group) {
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(!group.getValid(gate_id, word)) {
             continue;
         }
-        LogicValue fval = LogicValue::ONE;
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        
-        for( unsigned int inputs = 0; inputs < fanin.size(); inputs++ ){
-            fval &= (injection_site && ((assoc_faults[i]->faultGateNet()-1) == inputs))
-            ? assoc_faults[i]->faultSA() : fanin[inputs]->getFaultyValue(assoc_faults[i]);
-        }
-        f_vals[i] = (injection_site && (assoc_faults[i]->faultGateNet() == 0)) ? assoc_faults[i]->faultSA() : ~fval;
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+        PackedLogicValue fval = faultyFanin(group, 0, word);
+        for(unsigned int i = 1; i < fanin.size(); i++) {
+            fval = fval & faultyFanin(group, i, word);
         }
+        diverged |= commitFaulty(group, word, ~fval);
     }
+    return diverged;
 }
 
 /********************************************************/
@@ -160,42 +197,28 @@ void NandGate::faultEvaluate(){
 void OrGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    LogicValue val = fanin[0]->getOut();
+    LogicValue val = getFanin(0)->getOut();
     for(unsigned int i = 1; i<fanin.size(); i++) {
-        val = val | fanin[i]->getOut();
+        val = val | getFanin(i)->getOut();
     }
     output = val;
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    commitOutput(previous);
     setGIC();
 }
 
-void OrGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for( unsigned int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
+bool OrGate::faultEvaluate(FaultGroup & group) {
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(!group.getValid(gate_id, word)) {
             continue;
         }
-        LogicValue fval = LogicValue::ZERO;
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        
-        for( unsigned int inputs = 0; inputs < fanin.size(); inputs++ ){
-            fval |= (injection_site && (assoc_faults[i]->faultGateNet()-1 == inputs))
-            ? assoc_faults[i]->faultSA() : fanin[inputs]->getFaultyValue(assoc_faults[i]);
-        }
-        f_vals[i] = (injection_site && (assoc_faults[i]->faultGateNet() == 0)) ? assoc_faults[i]->faultSA() : fval;
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+        PackedLogicValue fval = faultyFanin(group, 0, word);
+        for(unsigned int i = 1; i < fanin.size(); i++) {
+            fval = fval | faultyFanin(group, i, word);
         }
+        diverged |= commitFaulty(group, word, fval);
     }
+    return diverged;
 }
 
 /********************************************************/
@@ -205,42 +228,28 @@ void OrGate::faultEvaluate(){
 void NorGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    LogicValue val = fanin[0]->getOut();
+    LogicValue val = getFanin(0)->getOut();
     for(unsigned int i = 1; i<fanin.size(); i++) {
-        val = val | fanin[i]->getOut();
+        val = val | getFanin(i)->getOut();
     }
     output = ~val;
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    commitOutput(previous);
     setGIC();
 }
 
-void NorGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for( unsigned int i = 0; i <NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
+bool NorGate::faultEvaluate(FaultGroup & group) {
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(!group.getValid(gate_id, word)) {
             continue;
         }
-        LogicValue fval = LogicValue::ZERO;
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        
-        for( unsigned int inputs = 0; inputs < fanin.size(); inputs++ ){
-            fval |= (injection_site && (assoc_faults[i]->faultGateNet()-1 == inputs))
-            ? assoc_faults[i]->faultSA() : fanin[inputs]->getFaultyValue(assoc_faults[i]);
-        }
-        f_vals[i] = (injection_site && (assoc_faults[i]->faultGateNet() == 0)) ? assoc_faults[i]->faultSA() : ~fval;
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+        PackedLogicValue fval = faultyFanin(group, 0, word);
+        for(unsigned int i = 1; i < fanin.size(); i++) {
+            fval = fval | faultyFanin(group, i, word);
         }
+        diverged |= commitFaulty(group, word, ~fval);
     }
+    return diverged;
 }
 
 /********************************************************/
@@ -251,42 +260,28 @@ void NorGate::faultEvaluate(){
 void XorGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    LogicValue val = fanin[0]->getOut();
+    LogicValue val = getFanin(0)->getOut();
     for(unsigned int i = 1; i<fanin.size(); i++) {
-        val = val ^ fanin[i]->getOut();
+        val = val ^ getFanin(i)->getOut();
     }
     output = val;
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    commitOutput(previous);
     setGIC();
 }
 
-void XorGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for( unsigned int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
+bool XorGate::faultEvaluate(FaultGroup & group) {
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(!group.getValid(gate_id, word)) {
             continue;
         }
-        LogicValue fval = LogicValue::ZERO;
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        
-        for( unsigned int inputs = 0; inputs < fanin.size(); inputs++ ){
-            fval ^= (injection_site && (assoc_faults[i]->faultGateNet()-1 == inputs))
-            ? assoc_faults[i]->faultSA() : fanin[inputs]->getFaultyValue(assoc_faults[i]);
-        }
-        f_vals[i] = (injection_site && (assoc_faults[i]->faultGateNet() == 0)) ? assoc_faults[i]->faultSA() : fval;
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+        PackedLogicValue fval = faultyFanin(group, 0, word);
+        for(unsigned int i = 1; i < fanin.size(); i++) {
+            fval = fval ^ faultyFanin(group, i, word);
         }
+        diverged |= commitFaulty(group, word, fval);
     }
+    return diverged;
 }
 
 /********************************************************/
@@ -296,42 +291,28 @@ void XorGate::faultEvaluate(){
 void XnorGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    LogicValue val = fanin[0]->getOut();
+    LogicValue val = getFanin(0)->getOut();
     for(unsigned int i = 1; i<fanin.size(); i++) {
-        val = val ^ fanin[i]->getOut();
+        val = val ^ getFanin(i)->getOut();
     }
     output = ~val;
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    commitOutput(previous);
     setGIC();
 }
 
-void XnorGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for( unsigned int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
+bool XnorGate::faultEvaluate(FaultGroup & group) {
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(!group.getValid(gate_id, word)) {
             continue;
         }
-        LogicValue fval = LogicValue::ZERO;
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        
-        for( unsigned int inputs = 0; inputs < fanin.size(); inputs++ ){
-            fval ^= (injection_site && (assoc_faults[i]->faultGateNet()-1 == inputs))
-            ? assoc_faults[i]->faultSA() : fanin[inputs]->getFaultyValue(assoc_faults[i]);
-        }
-        f_vals[i] = (injection_site && (assoc_faults[i]->faultGateNet() == 0)) ? assoc_faults[i]->faultSA() : ~fval;
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+        PackedLogicValue fval = faultyFanin(group, 0, word);
+        for(unsigned int i = 1; i < fanin.size(); i++) {
+            fval = fval ^ faultyFanin(group, i, word);
         }
+        diverged |= commitFaulty(group, word, ~fval);
     }
+    return diverged;
 }
 
 /********************************************************/
@@ -340,36 +321,19 @@ void XnorGate::faultEvaluate(){
 void NotGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    output = ~(fanin[0]->getOut());
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    output = ~(getFanin(0)->getOut());
+    commitOutput(previous);
     setGIC();
 }
 
-void NotGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for(unsigned int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
-            continue;
-        }
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        if(injection_site) {
-            f_vals[i] = (assoc_faults[i]->faultGateNet() == 0) ? assoc_faults[i]->faultSA() : ~assoc_faults[i]->faultSA() ;
-        } else {
-            f_vals[i] = ~(fanin[0]->getFaultyValue(assoc_faults[i]));
-        }
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+bool NotGate::faultEvaluate(FaultGroup & group) {
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(group.getValid(gate_id, word)) {
+            diverged |= commitFaulty(group, word, ~faultyFanin(group, 0, word));
         }
     }
+    return diverged;
 }
 
 /********************************************************/
@@ -378,36 +342,19 @@ void NotGate::faultEvaluate(){
 void BufGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    output = fanin[0]->getOut();
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    output = getFanin(0)->getOut();
+    commitOutput(previous);
     setGIC();
 }
 
-void BufGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for(unsigned int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
-            continue;
-        }
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        if(injection_site) {
-            f_vals[i] = assoc_faults[i]->faultSA() ;
-        } else {
-            f_vals[i] = fanin[0]->getFaultyValue(assoc_faults[i]);
-        }
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+bool BufGate::faultEvaluate(FaultGroup & group) {
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(group.getValid(gate_id, word)) {
+            diverged |= commitFaulty(group, word, faultyFanin(group, 0, word));
         }
     }
+    return diverged;
 }
 
 /********************************************************/
@@ -417,40 +364,28 @@ void BufGate::faultEvaluate(){
 void OutputGate::evaluate() {
     //default logic sim
     LogicValue previous = output;
-    output = fanin[0]->getOut();
-    
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    output = getFanin(0)->getOut();
+    commitOutput(previous);
 }
 
-void OutputGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for( int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
+bool OutputGate::faultEvaluate(FaultGroup & group) {
+    PackedLogicValue good(output);
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        uint64_t mask = group.getValid(gate_id, word);
+        if(!mask) {
             continue;
         }
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        if(injection_site) {
-            f_vals[i] = assoc_faults[i]->faultSA() ;
-        } else {
-            f_vals[i] = fanin[0]->getFaultyValue(assoc_faults[i]);
-        }
-        
-        if((f_vals[i] != output) && (output != LogicValue::X) && (f_vals[i] != LogicValue::X)){
-            if(!assoc_faults[i]->isDetected()){
-                std::cerr << assoc_faults[i]->faultGateId() << " "
-                << assoc_faults[i]->faultGateNet() << " "
-                << assoc_faults[i]->faultSA().ascii() << std::endl;
+        PackedLogicValue fval = faultyFanin(group, 0, word);
+        for(unsigned int slot = group.firstSite(gate_id); slot != FaultGroup::NO_SLOT; slot = group.nextSite(slot)) {
+            if((slot >> 6) == word) {
+                fval.set(slot & 63, group.getFault(slot)->faultSA());
             }
-            assoc_faults[i]->setDetected();
         }
+        group.setFaulty(gate_id, word, fval);
+        //detected where the faulty and good values differ and neither is X
+        group.getDetected(word) |= mask & ((fval.lo ^ good.lo) | (fval.hi ^ good.hi)) & ~fval.isX() & ~good.isX();
     }
+    return false;
 }
 
 /********************************************************/
@@ -463,27 +398,24 @@ void InputGate::evaluate() {
     dirty = true;
 }
 
-void InputGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for( int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
-            continue;
-        }
-        if(gate_id != assoc_faults[i]->faultGateId()){
-            continue;
-        }
-        f_vals[i] = assoc_faults[i]->faultSA();
-        
-        if(f_vals[i] != output){
-            propagates = true;
-            diverge(assoc_faults[i]);
+bool InputGate::faultEvaluate(FaultGroup & group) {
+    //only the faults on the input itself are valid here
+    bool diverged = false;
+    for(unsigned int slot = group.firstSite(gate_id); slot != FaultGroup::NO_SLOT; slot = group.nextSite(slot)) {
+        group.injectState(gate_id, slot, group.getFault(slot)->faultSA());
+    }
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        if(group.getValid(gate_id, word)) {
+            diverged |= commitFaulty(group, word, group.getStored(gate_id, word));
         }
     }
+    return diverged;
 }
 
-void InputGate::setInput(LogicValue::VALUES in) { //must be used to set value
+bool InputGate::setInput(LogicValue::VALUES in) { //must be used to set value
+    bool changed = (output != in);
     output = in;
+    return changed;
 }
 
 /********************************************************/
@@ -527,44 +459,35 @@ void TieZGate::evaluate() {
 
 void DffGate::evaluate() {
     LogicValue previous = output;
-    output = fanin[0]->getOut();
-    dirty = (output != previous);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-        toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-        toggled_down = true;
-    }
+    output = getFanin(0)->getOut();
+    commitOutput(previous);
 }
 
-void DffGate::faultEvaluate(){
-    //fault sim;
-    propagates = false;
-    for(unsigned int i = 0; i < NUM_FAULT_INJECT; i++){
-        if(!valid[i]){
-            continue;
-        }
-        bool injection_site = (gate_id == assoc_faults[i]->faultGateId());
-        if(injection_site) {
-            f_vals[i] = assoc_faults[i]->faultSA();
-        }
-        
-        if(f_vals[i] != output && output!=LogicValue::X){
-            propagates = true;
-            diverge(assoc_faults[i]);
+bool DffGate::faultEvaluate(FaultGroup & group) {
+    //valid slots hold the faulty state latched last cycle, a fault on the flip flop overrides it
+    for(unsigned int slot = group.firstSite(gate_id); slot != FaultGroup::NO_SLOT; slot = group.nextSite(slot)) {
+        group.injectState(gate_id, slot, group.getFault(slot)->faultSA());
+    }
+    if(output == LogicValue::X) {
+        return false;
+    }
+    PackedLogicValue good(output);
+    bool diverged = false;
+    for(unsigned int word = 0; word < group.getNumWords(); word++) {
+        PackedLogicValue fval = group.getStored(gate_id, word);
+        uint64_t mask = group.getValid(gate_id, word) & ((fval.lo ^ good.lo) | (fval.hi ^ good.hi));
+        if(mask) {
+            diverge(group, word, mask, fval);
+            diverged = true;
         }
     }
+    return diverged;
 }
 
 void DffGate::setDff(LogicValue::VALUES in) {
     output = in;
 }
 
-void DffGate::injectStoredFault(Fault * flt, LogicValue val){
-    assoc_faults[flt->getFID() % NUM_FAULT_INJECT] = flt;
-    f_vals[flt->getFID() % NUM_FAULT_INJECT] = val;
-    valid[flt->getFID() % NUM_FAULT_INJECT] = true;
-}
 /********************************************************/
 // MUX2
 /********************************************************/
@@ -572,19 +495,13 @@ void DffGate::injectStoredFault(Fault * flt, LogicValue val){
 void Mux2Gate::evaluate() {
     LogicValue previous = output;
 
-    if(fanin[0]->getOut() == LogicValue::Z || fanin[0]->getOut() == LogicValue::X) {
+    if(getFanin(0)->getOut() == LogicValue::Z || getFanin(0)->getOut() == LogicValue::X) {
         output = LogicValue::X;
     } else {
-        output = (fanin[0]->getOut() == LogicValue::ONE) ? fanin[2]->getOut() : fanin[1]->getOut();
+        output = (getFanin(0)->getOut() == LogicValue::ONE) ? getFanin(2)->getOut() : getFanin(1)->getOut();
     }
 
-    dirty = (previous != output);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-	toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-	toggled_down = true;
-    }
+    commitOutput(previous);
     setGIC();
 }
 
@@ -595,16 +512,10 @@ void Mux2Gate::evaluate() {
 void TristateGate::evaluate() {
     LogicValue previous = output;
 
-    if(fanin[1]->getOut() == LogicValue::ZERO) {
-        output = fanin[0]->getOut();
+    if(getFanin(1)->getOut() == LogicValue::ZERO) {
+        output = getFanin(0)->getOut();
     } else {
         output = LogicValue::Z;
     }
-    dirty = (previous != output);
-    if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
-	toggled_up = true;
-    }
-    if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
-	toggled_down = true;
-    }
+    commitOutput(previous);
 }
@@ -30,12 +30,26 @@
 #include "Type.h"
 #include <vector>
 #include <map>
+#include "Arena.h"
+#include "SmallVector.h"
 #include "Fault.h"
+#include "FaultGroup.h"
 
+class Gate;
 class InputGate;
 class OutputGate;
 class DffGate;
 
+#define GATE_INLINE_FANIN 4
+
+//adjacency and GIC storage, from the Circuit's arena when the gate belongs to one.
+//adjacency holds 32 bit gate ids resolved through the gate table, up to GATE_INLINE_FANIN
+//connections are stored in the Gate itself.
+typedef SmallVector<uint32_t, GATE_INLINE_FANIN> GateList;
+//gate of id g at [g - 1], the Circuit's allGates
+typedef std::vector<Gate *> GateTable;
+typedef std::vector<bool, ArenaAllocator<bool> > GICBitmap;
+
 //Polymorphic "gate" type. Evaluate is a hot function.
 class Gate {
 public:
@@ -64,47 +78,58 @@ protected:
     unsigned int gate_id;
     enum GateType m_type;
     LogicValue output;
-    std::vector<Gate *> fanin;
-    std::vector<Gate *> fanout;
+    GateList fanin;
+    GateList fanout;
+    const GateTable * gates; //resolves the ids in fanin and fanout
     bool dirty; //output changed during eval;
     unsigned int levelnum;
     unsigned int delay;  //nanoseconds KEEP
-    bool scheduled;
-    
-    std::vector<bool> GIC_coverage;
-    //faulty gate information
-    bool propagates;
-    LogicValue f_vals[NUM_FAULT_INJECT];
-    Fault * assoc_faults[NUM_FAULT_INJECT];
-    bool valid[NUM_FAULT_INJECT];
     
+    GICBitmap GIC_coverage;
+    const unsigned char * lut; //GateLUT entries set by Circuit, NULL for gates evaluated the long way
+    bool lut_gic;              //no tie fanins, so the LUT GIC slot is this gate's slot
     bool toggled_up = false;
     bool toggled_down = false;
     //meta-information from faulty circuit
     static unsigned short fault_round;
     static unsigned int num_injected; 
+
+    //faulty machine building blocks, word is a 64 slot word of the FaultGroup
+    inline PackedLogicValue faultyFanin(FaultGroup & group, unsigned int idx, unsigned int word);
+    bool commitFaulty(FaultGroup & group, unsigned int word, PackedLogicValue val);
+    void diverge(FaultGroup & group, unsigned int word, uint64_t diverged, PackedLogicValue val);
+
+    //shared tail of evaluate(): dirty flag and toggle tracking
+    inline void commitOutput(LogicValue previous) {
+        dirty = (output != previous);
+        if((previous == LogicValue::ZERO) && (output == LogicValue::ONE)) {
+            toggled_up = true;
+        }
+        if((previous == LogicValue::ONE) && (output == LogicValue::ZERO)) {
+            toggled_down = true;
+        }
+    }
     
 public:
     bool calc_GIC;
-    Gate(unsigned int idx) : gate_id(idx), output(LogicValue::X) {
-        for(int i = 0; i < NUM_FAULT_INJECT; i++) {valid[i] = false;}
-        
-    }
-    Gate(unsigned int idx, GateType type, unsigned int level) : gate_id(idx), m_type (type), output(LogicValue::X), levelnum(level), scheduled(false) {
-        for(int i = 0; i < NUM_FAULT_INJECT; i++) {valid[i] = false;}
-    }
+    Gate(unsigned int idx) : gate_id(idx), output(LogicValue::X), gates(NULL), lut(NULL), lut_gic(false), calc_GIC(false) {}
+    Gate(unsigned int idx, GateType type, unsigned int level) : gate_id(idx), m_type (type), output(LogicValue::X), gates(NULL), levelnum(level), delay(0), lut(NULL), lut_gic(false), calc_GIC(false) {}
     Gate(unsigned int idx, std::vector<Gate *> fin, std::vector<Gate *> fout, GateType type)
-        : gate_id(idx), m_type(type), output(LogicValue::X),  fanin(fin), fanout(fout) {
-            for(int i = 0; i < NUM_FAULT_INJECT; i++) {valid[i] = false;}
-        }
+        : gate_id(idx), m_type(type), output(LogicValue::X), gates(NULL), lut(NULL), lut_gic(false), calc_GIC(false) {
+        setFanin(fin);
+        setFanout(fout);
+    }
     virtual ~Gate() { }
     
     virtual void evaluate(); //eval and schedule if transition
+    inline void evaluateByType();  //non-virtual dispatch on m_type, used by the sim loops
+    void evaluateLUT();            //one table load for output and GIC slot
+    inline bool faultEvaluateByType(FaultGroup & group);
     
     void createGIC(){
         unsigned int num_gic = 0x01;
         for(int i = 0; i<fanin.size(); i++) {
-            if(fanin[i]->type() != TIE_ZERO && fanin[i]->type() != TIE_ONE) {
+            if(getFanin(i)->type() != TIE_ZERO && getFanin(i)->type() != TIE_ONE) {
                 num_gic = num_gic << 1;
             }
         }
@@ -130,21 +155,41 @@ public:
     inline LogicValue getOut() {
         return output;
     }
-    const std::vector<Gate *>& getFanout();
-    const std::vector<Gate *>& getFanin();
+    //gate ids, getFanin(idx)/getFanout(idx) resolve them
+    const GateList& getFanout();
+    const GateList& getFanin();
+
+    //moves adjacency and GIC storage into arena, call before any fanin/fanout is added
+    inline void useArena(Arena * arena, size_t num_fanin, size_t num_fanout) {
+        GIC_coverage = GICBitmap(ArenaAllocator<bool>(arena));
+        fanin.reserve(num_fanin, arena);
+        fanout.reserve(num_fanout, arena);
+    }
+
+    //table the fanin/fanout ids are looked up in, set by Circuit for its gates. The gates added
+    //must be in it under their id.
+    inline void setGateTable(const GateTable * table) {
+        gates = table;
+    }
 
     //fanin/out methods
     inline void addFanin(Gate * gate) {
-        fanin.push_back(gate);
+        fanin.push_back(gate->gate_id);
     }
     inline void addFanout(Gate * gate) {
-        fanout.push_back(gate);
+        fanout.push_back(gate->gate_id);
     }
     inline void setFanin(std::vector<Gate *>& set_fanin) {
-        fanin = set_fanin;
+        fanin.clear();
+        for(unsigned int i = 0; i < set_fanin.size(); i++) {
+            addFanin(set_fanin[i]);
+        }
     }
     inline void setFanout(std::vector<Gate *>& set_fanout) {
-        fanout = set_fanout;
+        fanout.clear();
+        for(unsigned int i = 0; i < set_fanout.size(); i++) {
+            addFanout(set_fanout[i]);
+        }
     }
     inline size_t getNumFanin() {
         return fanin.size();
@@ -153,9 +198,15 @@ public:
         return fanout.size();
     }
     inline Gate* getFanin(unsigned int idx) {
-        return fanin[idx];
+        return (*gates)[fanin[idx] - 1];
     }
     inline Gate* getFanout(unsigned int idx) {
+        return (*gates)[fanout[idx] - 1];
+    }
+    inline unsigned int getFaninId(unsigned int idx) {
+        return fanin[idx];
+    }
+    inline unsigned int getFanoutId(unsigned int idx) {
         return fanout[idx];
     }
     inline void clearFanin() {
@@ -164,6 +215,15 @@ public:
     inline void clearFanout() {
         fanout.clear();
     }
+    //netlist editing for Circuit::simplify, replace every occurrence and remove one
+    void replaceFanin(Gate * from, Gate * to);
+    void replaceFanout(Gate * from, Gate * to);
+    inline void removeFanin(unsigned int idx) {
+        fanin.erase(fanin.begin() + idx);
+    }
+    void removeFanout(Gate * gate);
+    //maps every fanin/fanout id g to new_id[g], after Circuit renumbers its gates
+    void renumberAdjacency(const std::vector<unsigned int>& new_id);
 
     //Gate info methods
     inline unsigned int getLevel() {
@@ -181,34 +241,14 @@ public:
     inline unsigned int getId() {
         return gate_id;
     }
-    inline void setScheduled() {
-        scheduled = true;
-    }
-    inline void unsetScheduled(){
-        scheduled = false;
-    }
-    inline bool isScheduled(){
-        return scheduled;
+    inline void setId(unsigned int idx) {
+        gate_id = idx;
     }
 
-    //faulty gate methods
-    void diverge(Fault *);
-    void clearFaultValid();
-    virtual void faultEvaluate() {}
-    
-    inline bool propagatesFault(){
-        return propagates;
-    }
-    inline void addFault(Fault * flt){
-        assoc_faults[flt->getFID() % NUM_FAULT_INJECT] = flt;
-        valid[flt->getFID() % NUM_FAULT_INJECT] = true;
-    }
-    inline LogicValue getFaultyValue(Fault * flt){
-        if(valid[flt->getFID() % NUM_FAULT_INJECT]){
-            return f_vals[flt->getFID() % NUM_FAULT_INJECT];
-        } else {
-            return output;
-        }
+    //faulty gate methods, compute the valid slots of the group and return true if any diverged
+    //from the good value (the fault propagates to the fanouts)
+    virtual bool faultEvaluate(FaultGroup &) {
+        return false;
     }
     static void setFaultRound(unsigned short round) {
         fault_round = round;
@@ -221,11 +261,11 @@ public:
         if(!calc_GIC) return;
         unsigned int idx = 0;
         for(unsigned int i = 0; i < fanin.size(); i++){
-            if(fanin[i]->type() == TIE_ZERO || fanin[i]->type() == TIE_ONE) continue;
-            if(fanin[i]->getOut() == LogicValue::X || fanin[i]->getOut() == LogicValue::Z){
+            if(getFanin(i)->type() == TIE_ZERO || getFanin(i)->type() == TIE_ONE) continue;
+            if(getFanin(i)->getOut() == LogicValue::X || getFanin(i)->getOut() == LogicValue::Z){
                 return;
             } else {
-                if(fanin[i]->getOut() == LogicValue::ONE){
+                if(getFanin(i)->getOut() == LogicValue::ONE){
                     idx = (idx << 1) | 0x01;
                 }
                 else {
@@ -249,6 +289,17 @@ public:
     inline unsigned int getNumGICPts(){
         return GIC_coverage.size();
     }
+
+    inline void setLUT(const unsigned char * table, bool gic) {
+        lut = table;
+        lut_gic = gic;
+    }
+    inline const unsigned char * getLUT() {
+        return lut;
+    }
+    inline bool hasLUTGIC() {
+        return lut_gic;
+    }
     
     inline bool hasToggled() {
         return (toggled_up && toggled_down);
@@ -274,7 +325,7 @@ public:
         : Gate(gid, fin, fout, Gate::AND) {}
     ~AndGate() {};
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual AndGate* clone() {
         return new AndGate(*this);
     }
@@ -287,7 +338,7 @@ public:
         : Gate(gid, fin, fout, Gate::NAND) {}
     ~NandGate() {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual NandGate* clone() {
         return new NandGate(*this);
     }
@@ -300,7 +351,7 @@ public:
         : Gate(gid, fin, fout, Gate::OR) {}
     ~OrGate() {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual OrGate* clone() {
         return new OrGate(*this);
     }
@@ -313,7 +364,7 @@ public:
         : Gate(gid, fin, fout, Gate::NOR) {}
     ~NorGate() {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual NorGate* clone() {
         return new NorGate(*this);
     }
@@ -326,7 +377,7 @@ public:
         : Gate(gid, fin, fout, Gate::XOR) {}
     ~XorGate() {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual XorGate* clone() {
         return new XorGate(*this);
     }
@@ -339,7 +390,7 @@ public:
         : Gate(gid, fin, fout, Gate::XNOR) {}
     ~XnorGate () {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual XnorGate* clone() {
         return new XnorGate(*this);
     }
@@ -352,7 +403,7 @@ public:
         : Gate(gid, fin, fout, Gate::NOT) {}
     ~NotGate() {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual NotGate* clone() {
         return new NotGate(*this);
     }
@@ -365,8 +416,8 @@ public:
         : Gate(gid, fin, fout, Gate::INPUT) {}
     ~InputGate() {}
     void evaluate();
-    void faultEvaluate();
-    void setInput(LogicValue::VALUES);
+    bool faultEvaluate(FaultGroup & group);
+    bool setInput(LogicValue::VALUES); //returns true if the value changed
 
     virtual InputGate* clone() {
         return new InputGate(*this);
@@ -380,7 +431,7 @@ public:
         : Gate(gid, fin, fout, Gate::OUTPUT) {}
     ~OutputGate() {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual OutputGate* clone() {
         return new OutputGate(*this);
     }
@@ -394,7 +445,9 @@ public:
         : Gate(gid, fin, fout, Gate::TIE_ZERO) {}
     ~TieZeroGate() {}
     void evaluate();
-    void faultEvaluate() {}
+    bool faultEvaluate(FaultGroup &) {
+        return false;
+    }
     virtual TieZeroGate* clone() {
         return new TieZeroGate(*this);
     }
@@ -407,7 +460,9 @@ public:
         : Gate(gid, fin, fout, Gate::TIE_ONE) {}
     ~TieOneGate() {}
     void evaluate();
-    void faultEvaluate() {}
+    bool faultEvaluate(FaultGroup &) {
+        return false;
+    }
     virtual TieOneGate* clone() {
         return new TieOneGate(*this);
     }
@@ -420,7 +475,9 @@ public:
         : Gate(gid, fin, fout, Gate::TIE_X) {}
     ~TieXGate() {}
     void evaluate();
-    void faultEvaluate() {}
+    bool faultEvaluate(FaultGroup &) {
+        return false;
+    }
     virtual TieXGate* clone() {
         return new TieXGate(*this);
     }
@@ -433,7 +490,9 @@ public:
         : Gate(gid, fin, fout, Gate::TIE_Z) {}
     ~TieZGate() {}
     void evaluate();
-    void faultEvaluate() {}
+    bool faultEvaluate(FaultGroup &) {
+        return false;
+    }
     virtual TieZGate* clone() {
         return new TieZGate(*this);
     }
@@ -446,7 +505,7 @@ public:
         : Gate(gid, fin, fout, Gate::BUF) {}
     ~BufGate() {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     virtual BufGate* clone() {
         return new BufGate(*this);
     }
@@ -461,9 +520,8 @@ public:
         : Gate(gid, fin, fout, Gate::D_FF) {doneGoodSim = false;}
     ~DffGate() {}
     void evaluate();
-    void faultEvaluate();
+    bool faultEvaluate(FaultGroup & group);
     void setDff(LogicValue::VALUES);
-    void injectStoredFault(Fault * flt, LogicValue val);
     virtual DffGate* clone() {
         return new DffGate(*this);
     }
@@ -476,7 +534,9 @@ public:
         : Gate(gid, fin, fout, Gate::MUX_2) {}
     ~Mux2Gate() {}
     void evaluate();
-    void faultEvaluate() {}
+    bool faultEvaluate(FaultGroup &) {
+        return false;
+    }
     virtual Mux2Gate* clone() {
         return new Mux2Gate(*this);
     }
@@ -489,7 +549,9 @@ public:
         : Gate(gid, fin, fout, Gate::TRISTATE) {}
     ~TristateGate() {}
     void evaluate();
-    void faultEvaluate() {}
+    bool faultEvaluate(FaultGroup &) {
+        return false;
+    }
     virtual TristateGate* clone() {
         return new TristateGate(*this);
     }
@@ -508,5 +570,62 @@ inline OutputGate* Gate::castOutput() {
     return dynamic_cast<OutputGate*>(this);
 }
 
+//qualified calls bind statically, so the hot loops avoid the vtable
+inline void Gate::evaluateByType() {
+    if(lut != NULL) {
+        evaluateLUT();
+        return;
+    }
+    switch(m_type) {
+    case AND:      static_cast<AndGate*>(this)->AndGate::evaluate(); break;
+    case NAND:     static_cast<NandGate*>(this)->NandGate::evaluate(); break;
+    case OR:       static_cast<OrGate*>(this)->OrGate::evaluate(); break;
+    case NOR:      static_cast<NorGate*>(this)->NorGate::evaluate(); break;
+    case XOR:      static_cast<XorGate*>(this)->XorGate::evaluate(); break;
+    case XNOR:     static_cast<XnorGate*>(this)->XnorGate::evaluate(); break;
+    case NOT:      static_cast<NotGate*>(this)->NotGate::evaluate(); break;
+    case BUF:      static_cast<BufGate*>(this)->BufGate::evaluate(); break;
+    case INPUT:    static_cast<InputGate*>(this)->InputGate::evaluate(); break;
+    case OUTPUT:   static_cast<OutputGate*>(this)->OutputGate::evaluate(); break;
+    case D_FF:     static_cast<DffGate*>(this)->DffGate::evaluate(); break;
+    case MUX_2:    static_cast<Mux2Gate*>(this)->Mux2Gate::evaluate(); break;
+    case TRISTATE: static_cast<TristateGate*>(this)->TristateGate::evaluate(); break;
+    case TIE_ZERO: static_cast<TieZeroGate*>(this)->TieZeroGate::evaluate(); break;
+    case TIE_ONE:  static_cast<TieOneGate*>(this)->TieOneGate::evaluate(); break;
+    case TIE_X:    static_cast<TieXGate*>(this)->TieXGate::evaluate(); break;
+    case TIE_Z:    static_cast<TieZGate*>(this)->TieZGate::evaluate(); break;
+    default:       Gate::evaluate(); break;
+    }
+}
+
+inline bool Gate::faultEvaluateByType(FaultGroup & group) {
+    switch(m_type) {
+    case AND:    return static_cast<AndGate*>(this)->AndGate::faultEvaluate(group);
+    case NAND:   return static_cast<NandGate*>(this)->NandGate::faultEvaluate(group);
+    case OR:     return static_cast<OrGate*>(this)->OrGate::faultEvaluate(group);
+    case NOR:    return static_cast<NorGate*>(this)->NorGate::faultEvaluate(group);
+    case XOR:    return static_cast<XorGate*>(this)->XorGate::faultEvaluate(group);
+    case XNOR:   return static_cast<XnorGate*>(this)->XnorGate::faultEvaluate(group);
+    case NOT:    return static_cast<NotGate*>(this)->NotGate::faultEvaluate(group);
+    case BUF:    return static_cast<BufGate*>(this)->BufGate::faultEvaluate(group);
+    case INPUT:  return static_cast<InputGate*>(this)->InputGate::faultEvaluate(group);
+    case OUTPUT: return static_cast<OutputGate*>(this)->OutputGate::faultEvaluate(group);
+    case D_FF:   return static_cast<DffGate*>(this)->DffGate::faultEvaluate(group);
+    default:     return false; //tie, mux and tristate gates are not fault simulated
+    }
+}
+
+//faulty value of fanin idx, with the stuck at faults on that input of this gate applied
+inline PackedLogicValue Gate::faultyFanin(FaultGroup & group, unsigned int idx, unsigned int word) {
+    PackedLogicValue val = group.getFaulty(fanin[idx], word, getFanin(idx)->output);
+    for(unsigned int slot = group.firstSite(gate_id); slot != FaultGroup::NO_SLOT; slot = group.nextSite(slot)) {
+        Fault * flt = group.getFault(slot);
+        if((slot >> 6) == word && flt->faultGateNet() == idx + 1) {
+            val.set(slot & 63, flt->faultSA());
+        }
+    }
+    return val;
+}
+
 #endif
 
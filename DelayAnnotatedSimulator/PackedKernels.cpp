@@ -0,0 +1,103 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "PackedKernels.h"
+
+//portable fallback, one 64 bit word at a time
+struct ScalarOps {
+    typedef uint64_t vec;
+    static const unsigned int WORDS = 1;
+
+    static inline vec load(const uint64_t * src) { return *src; }
+    static inline void store(uint64_t * dst, vec val) { *dst = val; }
+    static inline vec zero() { return 0; }
+    static inline vec ones() { return ~0ULL; }
+    static inline vec and_(vec a, vec b) { return a & b; }
+    static inline vec or_(vec a, vec b) { return a | b; }
+    static inline vec xor_(vec a, vec b) { return a ^ b; }
+    static inline vec andnot(vec a, vec b) { return ~a & b; }
+};
+
+static const PackedKernel scalar_table[NUM_GATE_TYPES] = PACKED_KERNEL_TABLE(ScalarOps);
+
+const PackedKernel * scalarPackedKernels() {
+    return scalar_table;
+}
+
+PackedKernels::ISA PackedKernels::detect() {
+    if(isSupported(AVX512)) return AVX512;
+    if(isSupported(AVX2)) return AVX2;
+    return SCALAR;
+}
+
+bool PackedKernels::isSupported(ISA isa) {
+    if(table(isa) == NULL) {
+        return false;
+    }
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    switch(isa) {
+    case AVX2:
+        return __builtin_cpu_supports("avx2");
+    case AVX512:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return true;
+    }
+#else
+    return isa == SCALAR;
+#endif
+}
+
+const char * PackedKernels::name(ISA isa) {
+    switch(isa) {
+    case AVX2:
+        return "AVX2";
+    case AVX512:
+        return "AVX-512";
+    default:
+        return "SCALAR";
+    }
+}
+
+unsigned int PackedKernels::vectorWords(ISA isa) {
+    switch(isa) {
+    case AVX2:
+        return 4;
+    case AVX512:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+const PackedKernel * PackedKernels::table(ISA isa) {
+    switch(isa) {
+    case AVX2:
+        return avx2PackedKernels();
+    case AVX512:
+        return avx512PackedKernels();
+    default:
+        return scalarPackedKernels();
+    }
+}
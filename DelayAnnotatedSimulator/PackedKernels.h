@@ -0,0 +1,191 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef DelayAnnotatedSimulator_PackedKernels_h
+#define DelayAnnotatedSimulator_PackedKernels_h
+
+#include <cstdint>
+#include "Gates.h"
+#include "GateKernels.h"
+
+//Dual-rail evaluation kernels for the ParallelLogicSimulator. Each gate owns a block of
+//2 * words uint64_t in the value array: words lo words followed by words hi words, where bit p
+//of the block is bit 0/1 of the LogicValue code of pattern p (same encoding as PackedLogicValue).
+//words is always a multiple of the vector width of the kernel set in use.
+typedef void (*PackedKernel)(uint64_t * values, unsigned int gate, const unsigned int * fin, unsigned int num_fanin, unsigned int words);
+
+class PackedKernels {
+public:
+    enum ISA {
+        SCALAR = 0, //64 bit words, always available
+        AVX2,       //256 patterns per instruction
+        AVX512      //512 patterns per instruction
+    };
+
+    //widest kernel set the running cpu supports
+    static ISA detect();
+    static bool isSupported(ISA isa);
+    static const char * name(ISA isa);
+    //uint64_t per rail for one vector register
+    static unsigned int vectorWords(ISA isa);
+    //kernels indexed by Gate::GateType, INPUT is NULL
+    static const PackedKernel * table(ISA isa);
+};
+
+//one table per instruction set, each in its own translation unit built with the matching
+//compiler flags. The AVX tables are NULL when the compiler did not target that instruction set.
+const PackedKernel * scalarPackedKernels();
+const PackedKernel * avx2PackedKernels();
+const PackedKernel * avx512PackedKernels();
+
+//Kernel bodies, instantiated once per instruction set with an ops class V providing
+//vec, WORDS, load, store, zero, ones, and_, or_, xor_ and andnot (~a & b).
+template <class V>
+class PackedGateKernels {
+private:
+    typedef typename V::vec vec;
+
+    static inline uint64_t * lo(uint64_t * values, unsigned int gate, unsigned int words) {
+        return values + (size_t) gate * 2 * words;
+    }
+    static inline uint64_t * hi(uint64_t * values, unsigned int gate, unsigned int words) {
+        return values + (size_t) gate * 2 * words + words;
+    }
+    static inline vec isX(vec l, vec h) {
+        return V::andnot(h, l);
+    }
+    static inline void invert(vec & l, vec & h) {
+        vec x = isX(l, h);
+        l = V::or_(V::xor_(l, V::ones()), x);
+        h = V::andnot(V::or_(h, x), V::ones());
+    }
+
+public:
+    enum Op { AND, OR, XOR };
+
+    template <Op OP, bool INVERT>
+    static void reduce(uint64_t * values, unsigned int gate, const unsigned int * fin, unsigned int num_fanin, unsigned int words) {
+        for(unsigned int w = 0; w < words; w += V::WORDS) {
+            vec l = V::load(lo(values, fin[0], words) + w);
+            vec h = V::load(hi(values, fin[0], words) + w);
+            for(unsigned int i = 1; i < num_fanin; i++) {
+                vec rl = V::load(lo(values, fin[i], words) + w);
+                vec rh = V::load(hi(values, fin[i], words) + w);
+                if(OP == AND) {
+                    l = V::and_(l, rl);
+                    h = V::and_(h, rh);
+                } else if(OP == OR) {
+                    l = V::or_(l, rl);
+                    h = V::or_(h, rh);
+                } else {
+                    vec x = V::or_(isX(l, h), isX(rl, rh));
+                    l = V::or_(V::xor_(l, rl), x);
+                    h = V::andnot(x, V::xor_(h, rh));
+                }
+            }
+            if(INVERT) {
+                invert(l, h);
+            }
+            V::store(lo(values, gate, words) + w, l);
+            V::store(hi(values, gate, words) + w, h);
+        }
+    }
+
+    template <bool INVERT>
+    static void single(uint64_t * values, unsigned int gate, const unsigned int * fin, unsigned int, unsigned int words) {
+        for(unsigned int w = 0; w < words; w += V::WORDS) {
+            vec l = V::load(lo(values, fin[0], words) + w);
+            vec h = V::load(hi(values, fin[0], words) + w);
+            if(INVERT) {
+                invert(l, h);
+            }
+            V::store(lo(values, gate, words) + w, l);
+            V::store(hi(values, gate, words) + w, h);
+        }
+    }
+
+    template <LogicValue::VALUES VAL>
+    static void constant(uint64_t * values, unsigned int gate, const unsigned int *, unsigned int, unsigned int words) {
+        vec l = (VAL & 0x01) ? V::ones() : V::zero();
+        vec h = (VAL & 0x02) ? V::ones() : V::zero();
+        for(unsigned int w = 0; w < words; w += V::WORDS) {
+            V::store(lo(values, gate, words) + w, l);
+            V::store(hi(values, gate, words) + w, h);
+        }
+    }
+
+    //fin[0] select, fin[1] selected on ZERO, fin[2] selected on ONE, X otherwise
+    static void mux2(uint64_t * values, unsigned int gate, const unsigned int * fin, unsigned int, unsigned int words) {
+        for(unsigned int w = 0; w < words; w += V::WORDS) {
+            vec sl = V::load(lo(values, fin[0], words) + w);
+            vec sh = V::load(hi(values, fin[0], words) + w);
+            vec one = V::and_(sl, sh);
+            vec zero = V::andnot(V::or_(sl, sh), V::ones());
+            vec unknown = V::andnot(V::or_(one, zero), V::ones());
+            vec l = V::or_(V::or_(V::and_(one, V::load(lo(values, fin[2], words) + w)),
+                                  V::and_(zero, V::load(lo(values, fin[1], words) + w))), unknown);
+            vec h = V::or_(V::and_(one, V::load(hi(values, fin[2], words) + w)),
+                           V::and_(zero, V::load(hi(values, fin[1], words) + w)));
+            V::store(lo(values, gate, words) + w, l);
+            V::store(hi(values, gate, words) + w, h);
+        }
+    }
+
+    //fin[0] data, fin[1] active low enable, Z when not enabled
+    static void tristate(uint64_t * values, unsigned int gate, const unsigned int * fin, unsigned int, unsigned int words) {
+        for(unsigned int w = 0; w < words; w += V::WORDS) {
+            vec el = V::load(lo(values, fin[1], words) + w);
+            vec eh = V::load(hi(values, fin[1], words) + w);
+            vec enabled = V::andnot(V::or_(el, eh), V::ones());
+            vec l = V::and_(enabled, V::load(lo(values, fin[0], words) + w));
+            vec h = V::or_(V::and_(enabled, V::load(hi(values, fin[0], words) + w)), V::andnot(enabled, V::ones()));
+            V::store(lo(values, gate, words) + w, l);
+            V::store(hi(values, gate, words) + w, h);
+        }
+    }
+};
+
+//rows follow the order of Gate::GateType
+#define PACKED_KERNEL_TABLE(V) {                                   \
+    &PackedGateKernels<V>::constant<LogicValue::X>,    /*NONE*/     \
+    NULL,                                              /*INPUT*/    \
+    &PackedGateKernels<V>::single<false>,              /*OUTPUT*/   \
+    &PackedGateKernels<V>::reduce<PackedGateKernels<V>::AND, false>, \
+    &PackedGateKernels<V>::reduce<PackedGateKernels<V>::AND, true>,  \
+    &PackedGateKernels<V>::reduce<PackedGateKernels<V>::OR, false>,  \
+    &PackedGateKernels<V>::reduce<PackedGateKernels<V>::OR, true>,   \
+    &PackedGateKernels<V>::single<true>,               /*NOT*/      \
+    &PackedGateKernels<V>::reduce<PackedGateKernels<V>::XOR, false>, \
+    &PackedGateKernels<V>::reduce<PackedGateKernels<V>::XOR, true>,  \
+    &PackedGateKernels<V>::constant<LogicValue::ZERO>, /*TIE_ZERO*/ \
+    &PackedGateKernels<V>::constant<LogicValue::ONE>,  /*TIE_ONE*/  \
+    &PackedGateKernels<V>::constant<LogicValue::X>,    /*TIE_X*/    \
+    &PackedGateKernels<V>::constant<LogicValue::Z>,    /*TIE_Z*/    \
+    &PackedGateKernels<V>::single<false>,              /*BUF*/      \
+    &PackedGateKernels<V>::mux2,                       /*MUX_2*/    \
+    &PackedGateKernels<V>::tristate,                   /*TRISTATE*/ \
+    &PackedGateKernels<V>::single<false>               /*D_FF*/     \
+}
+
+#endif
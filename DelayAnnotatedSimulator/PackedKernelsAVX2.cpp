@@ -0,0 +1,55 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+//Built with -mavx2 (see Makefile). Nothing outside this file may call into it unless
+//PackedKernels::isSupported(PackedKernels::AVX2) is true.
+#include "PackedKernels.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+struct Avx2Ops {
+    typedef __m256i vec;
+    static const unsigned int WORDS = 4;
+
+    static inline vec load(const uint64_t * src) { return _mm256_loadu_si256((const __m256i *) src); }
+    static inline void store(uint64_t * dst, vec val) { _mm256_storeu_si256((__m256i *) dst, val); }
+    static inline vec zero() { return _mm256_setzero_si256(); }
+    static inline vec ones() { return _mm256_set1_epi64x(-1); }
+    static inline vec and_(vec a, vec b) { return _mm256_and_si256(a, b); }
+    static inline vec or_(vec a, vec b) { return _mm256_or_si256(a, b); }
+    static inline vec xor_(vec a, vec b) { return _mm256_xor_si256(a, b); }
+    static inline vec andnot(vec a, vec b) { return _mm256_andnot_si256(a, b); }
+};
+
+static const PackedKernel avx2_table[NUM_GATE_TYPES] = PACKED_KERNEL_TABLE(Avx2Ops);
+
+const PackedKernel * avx2PackedKernels() {
+    return avx2_table;
+}
+#else
+const PackedKernel * avx2PackedKernels() {
+    return NULL;
+}
+#endif
@@ -0,0 +1,58 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+//Built with -mavx512f (see Makefile). Nothing outside this file may call into it unless
+//PackedKernels::isSupported(PackedKernels::AVX512) is true.
+#include "PackedKernels.h"
+
+#ifdef __AVX512F__
+#include <immintrin.h>
+
+struct Avx512Ops {
+    typedef __m512i vec;
+    static const unsigned int WORDS = 8;
+
+    static inline vec load(const uint64_t * src) { return _mm512_loadu_si512((const void *) src); }
+    static inline void store(uint64_t * dst, vec val) { _mm512_storeu_si512((void *) dst, val); }
+    static inline vec zero() { return _mm512_setzero_si512(); }
+    static inline vec ones() { return _mm512_set1_epi64(-1); }
+    static inline vec and_(vec a, vec b) { return _mm512_and_si512(a, b); }
+    static inline vec or_(vec a, vec b) { return _mm512_or_si512(a, b); }
+    static inline vec xor_(vec a, vec b) { return _mm512_xor_si512(a, b); }
+    //GCC's _mm512_andnot_si512 passes an _mm512_undefined_epi32() merge operand, which
+    //-Wmaybe-uninitialized reports at every inlined call site. The zero-masked form with an
+    //all-ones mask has an explicit zero operand and still compiles to a plain vpandnq.
+    static inline vec andnot(vec a, vec b) { return _mm512_maskz_andnot_epi64((__mmask8) 0xFF, a, b); }
+};
+
+static const PackedKernel avx512_table[NUM_GATE_TYPES] = PACKED_KERNEL_TABLE(Avx512Ops);
+
+const PackedKernel * avx512PackedKernels() {
+    return avx512_table;
+}
+#else
+const PackedKernel * avx512PackedKernels() {
+    return NULL;
+}
+#endif
@@ -25,10 +25,9 @@
 #include "Simulator.h"
 
 std::vector<LogicValue> Simulator::getOutputs() {
-    std::vector<Gate*> outs = circuit->getOutputs();
     std::vector<LogicValue> ret;
-    for(unsigned int i = 0; i < outs.size(); i++) {
-        ret.push_back(outs[i]->getOut());
+    for(unsigned int i = 0; i < circuit->getNumOutput(); i++) {
+        ret.push_back(getPOValue(i));
     }
     return ret;
 }
@@ -39,7 +38,7 @@ void Simulator::simCycle(const std::vector<char>& input) {
 
 void Simulator::dumpPO(std::ostream& out_stream) {
     for(unsigned int i = 0; i < circuit->getNumOutput(); i++) {
-        out_stream << circuit->getOutput(i)->getOut().ascii();
+        out_stream << getPOValue(i).ascii();
     }
     out_stream << std::endl;
 }
@@ -47,7 +46,7 @@ void Simulator::dumpPO(std::ostream& out_stream) {
 //dumps the circuit state to output stream
 void Simulator::dumpState(std::ostream& out_stream) {
     for(unsigned int i = 0; i < circuit->getNumStateVar(); i++) {
-        out_stream << circuit->getStateVar(i)->getOut().ascii();
+        out_stream << getStateValue(i).ascii();
     }
     out_stream << std::endl;
 }
@@ -61,187 +60,847 @@ void Simulator::dumpGIC(std::ostream& out_stream){
  * LogicDelaySimulator
  ****************************************************************************/
 
+LogicSimulator::LogicSimulator(Circuit * ckt, Engine engine) : Simulator(ckt), netlist(ckt->getNetlist()), initialized(false),
+    last_calc_GIC(true), engine(engine), sweeping(engine == OBLIVIOUS), window_events(0), window_cycles(0)
+{
+    netlist->setFaninCounting(true);
+    touched.assign(netlist->getNumGates(), 0);
+
+    std::vector<std::vector<unsigned int> > levels(netlist->getNumLevels());
+    std::vector<unsigned int> level_sizes(netlist->getNumLevels(), 0);
+    for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+        level_sizes[netlist->getLevel(i)]++;
+        if(netlist->type(i) != Gate::INPUT && netlist->type(i) != Gate::D_FF) {
+            levels[netlist->getLevel(i)].push_back(i);
+        }
+    }
+    for(unsigned int i = 0; i < levels.size(); i++) {
+        sweep_order.insert(sweep_order.end(), levels[i].begin(), levels[i].end());
+    }
+    eventwheel = new EventWheel(level_sizes, netlist->getNumGates());
+
+    state_pos.assign(netlist->getNumGates(), 0);
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        state_pos[netlist->getStateVar(i)] = i;
+    }
+}
+
 void LogicSimulator::simCycle(const std::vector<char>& input) {
     //check if input is correct size
-    if(input.size() != circuit->getNumInput()) {
+    if(input.size() != netlist->getNumInput()) {
         std::cerr << "INVALID INPUT AT: " << cycle_id << std::endl;
     }
-    for(unsigned int i = 0; i < input.size(); i++) { //insert all inputs as events
-        InputGate * in = circuit->getInput(i);
-        if(in) {
-            in->setInput(LogicValue::fromChar(input[i]));
-            eventwheel->insertEvent(in);
-        } else {
-            std::cerr << "INVALID INPUT GATE: CKT ERROR" << std::endl;
-            exit(-1);
+    changed_inputs.clear();
+    for(unsigned int i = 0; i < input.size(); i++) {
+        unsigned int in = netlist->getInput(i);
+        LogicValue val = LogicValue::fromChar(input[i]);
+        if(val != netlist->getValue(in)) {
+            netlist->setValue(in, val);
+            changed_inputs.push_back(in);
         }
     }
 
-    //always schedule all state vars (there are some optimizations possible, but this is easiest for now)
-    for(unsigned int i = 0; i<circuit->getNumStateVar(); i++) {
-        eventwheel->insertEvent(circuit->getStateVar(i));
+    //global reset is a primary input, so it holds for the whole cycle
+    bool calc_GIC = (netlist->getValue(netlist->getGlobalReset()) != LogicValue::ONE);
+
+    //first cycle evaluates every gate once, afterwards only changes propagate.
+    //Gates evaluated during reset did not record GIC, every PI is propagated once reset is released
+    //so its fanouts record their current input combination.
+    bool first_cycle = !initialized;
+    if(first_cycle || (calc_GIC && !last_calc_GIC)) {
+        changed_inputs.clear();
+        for(unsigned int i = 0; i < netlist->getNumInput(); i++) {
+            changed_inputs.push_back(netlist->getInput(i));
+        }
+    }
+    if(first_cycle) {
+        touched.assign(netlist->getNumGates(), 1);
+        pending_state.assign(netlist->getNumStateVar(), true);
+        if(!sweeping) {
+            for(unsigned int i = 0; i < sweep_order.size(); i++) {
+                scheduleRegion(sweep_order[i]);
+            }
+        }
+        initialized = true;
     }
+    last_calc_GIC = calc_GIC;
 
-    Gate * gate_to_eval = eventwheel->getNextScheduled();
-    while (gate_to_eval != NULL) {
-        if(circuit->global_reset->getOut() == LogicValue::ONE){
-            gate_to_eval->calc_GIC = false;
-        } else {
-            gate_to_eval->calc_GIC = true;
+    unsigned int events = sweeping ? sweepCycle(calc_GIC) : eventCycle(calc_GIC);
+    if(first_cycle) {
+        //tie cells take their value without reporting a change, flip flops they feed latch it next cycle
+        pending_state.assign(netlist->getNumStateVar(), true);
+    }
+
+    GIC_log.push_back(netlist->calculateGIC());
+    Toggle_log.push_back(netlist->calculateToggle());
+    if(engine == AUTO) {
+        selectEngine(events);
+    }
+}
+
+//propagates the changed PIs, then latches the pending flip flops in state var order. A flip flop fed by
+//a PI or by a flip flop earlier in the order sees its value from this cycle, one fed by a later flip
+//flop or a combinational gate latches next cycle. Returns the number of events processed.
+unsigned int LogicSimulator::latchState(bool calc_GIC) {
+    for(unsigned int i = 0; i < changed_inputs.size(); i++) {
+        propagate(changed_inputs[i], changed_inputs[i]);
+    }
+    unsigned int events = changed_inputs.size();
+
+    for(unsigned int pos = pending_state.next(0); pos != StateVarSet::END; pos = pending_state.next(pos + 1)) {
+        pending_state.erase(pos);
+        unsigned int dff = netlist->getStateVar(pos);
+        events++;
+        //state GIC only changes when a flip flop does
+        if(netlist->evaluate(dff, calc_GIC)) {
+            propagate(dff, dff);
+            netlist->setStateGIC();
         }
-        gate_to_eval->evaluate();
-        if(!gate_to_eval->isDirty()) {
-            gate_to_eval = eventwheel->getNextScheduled();
+    }
+    return events;
+}
+
+//returns the number of events processed. The wheel holds fanout free region roots, touched marks
+//the gates inside a region that would have been scheduled on their own.
+unsigned int LogicSimulator::eventCycle(bool calc_GIC) {
+    unsigned int events = latchState(calc_GIC);
+    unsigned int root = eventwheel->getNextScheduled();
+    while (root != EventWheel::NO_EVENT) {
+        events += evaluateRegion(root, calc_GIC);
+        root = eventwheel->getNextScheduled();
+    }
+    return events;
+}
+
+//evaluates the touched members of a region in level order, the region's fanins are final since
+//they sit on lower levels than the root. Returns the number of gates evaluated.
+unsigned int LogicSimulator::evaluateRegion(unsigned int root, bool calc_GIC) {
+    unsigned int events = 0;
+    for(const unsigned int * member = netlist->regionBegin(root); member != netlist->regionEnd(root); ++member) {
+        unsigned int gate = *member;
+        if(!touched[gate]) {
             continue;
         }
+        touched[gate] = 0;
+        events++;
+        if(netlist->evaluate(gate, calc_GIC)) {
+            propagate(gate, root); //same region is later in this loop
+        }
+    }
+    return events;
+}
 
-        for(unsigned int i = 0; i<gate_to_eval->getNumFanout(); i++) {
-            if(gate_to_eval->getFanout(i)->type() != Gate::D_FF) {
-                eventwheel->insertEvent(gate_to_eval->getFanout(i));
+//evaluates every gate in the order the event wheel would, returns the number of events the
+//event wheel would have processed. Only gates with a changed fanin record GIC coverage.
+unsigned int LogicSimulator::sweepCycle(bool calc_GIC) {
+    unsigned int events = latchState(calc_GIC);
+    for(unsigned int i = 0; i < sweep_order.size(); i++) {
+        unsigned int gate = sweep_order[i];
+        bool scheduled = touched[gate];
+        touched[gate] = 0;
+        events += scheduled;
+        if(netlist->evaluate(gate, calc_GIC && scheduled)) {
+            propagate(gate, gate);
+        }
+    }
+    return events;
+}
+
+void LogicSimulator::selectEngine(unsigned int events) {
+    window_events += events;
+    if(++window_cycles < ACTIVITY_WINDOW) {
+        return;
+    }
+    double activity = (double) window_events / ((double) window_cycles * netlist->getNumGates());
+    if(!sweeping && activity > OBLIVIOUS_ENTER_ACTIVITY) {
+        sweeping = true;
+    } else if(sweeping && activity < OBLIVIOUS_EXIT_ACTIVITY) {
+        sweeping = false;
+    }
+    window_events = 0;
+    window_cycles = 0;
+}
+
+
+/****************************************************************************
+ * ParallelLogicSimulator
+ ****************************************************************************/
+
+ParallelLogicSimulator::ParallelLogicSimulator(Circuit * ckt, PackedKernels::ISA isa) : Simulator(ckt), netlist(ckt->getNetlist()), isa(isa), batch_size(1) {
+    kernels = PackedKernels::table(isa);
+    words = PackedKernels::vectorWords(isa);
+    //every pattern starts X: lo rail set, hi rail clear
+    values.assign(netlist->getNumGates() * 2 * words, 0);
+    for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+        std::fill(block(i), block(i) + words, ~0ULL);
+    }
+
+    std::vector<std::vector<unsigned int> > levels(netlist->getNumLevels());
+    for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+        if(netlist->type(i) != Gate::INPUT && netlist->type(i) != Gate::D_FF) {
+            levels[netlist->getLevel(i)].push_back(i);
+        }
+    }
+    for(unsigned int i = 0; i < levels.size(); i++) {
+        eval_order.insert(eval_order.end(), levels[i].begin(), levels[i].end());
+    }
+
+    //the event wheel evaluates PIs first, then flip flops in order, all before any other gate.
+    std::vector<unsigned int> state_pos(netlist->getNumGates(), netlist->getNumStateVar());
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        state_pos[netlist->getStateVar(i)] = i;
+    }
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        unsigned int src = netlist->getFanin(netlist->getStateVar(i), 0);
+        latch_same_pattern.push_back(netlist->type(src) == Gate::INPUT || state_pos[src] < i);
+    }
+    state_carry.assign(netlist->getNumStateVar(), LogicValue::X);
+}
+
+LogicValue ParallelLogicSimulator::getPatternValue(unsigned int gate, unsigned int pattern) const {
+    const uint64_t * lo = values.data() + (size_t) gate * 2 * words;
+    return PackedLogicValue(lo[pattern / 64], lo[words + pattern / 64]).get(pattern % 64);
+}
+
+void ParallelLogicSimulator::setPatternValue(unsigned int gate, unsigned int pattern, LogicValue val) {
+    uint64_t * lo = block(gate);
+    PackedLogicValue word(lo[pattern / 64], lo[words + pattern / 64]);
+    word.set(pattern % 64, val);
+    lo[pattern / 64] = word.lo;
+    lo[words + pattern / 64] = word.hi;
+}
+
+void ParallelLogicSimulator::simCycle(const std::vector<char>& input) {
+    simBatch(std::vector<std::vector<char> >(1, input));
+}
+
+void ParallelLogicSimulator::simBatch(const std::vector<std::vector<char> >& batch) {
+    batch_size = batch.size();
+    for(unsigned int p = 0; p < batch.size(); p++) {
+        if(batch[p].size() != netlist->getNumInput()) {
+            std::cerr << "INVALID INPUT AT: " << cycle_id << std::endl;
+        }
+        for(unsigned int i = 0; i < batch[p].size(); i++) {
+            setPatternValue(netlist->getInput(i), p, LogicValue::fromChar(batch[p][i]));
+        }
+    }
+
+    //pattern p only depends on patterns before it, so this settles in at most batch_size extra sweeps
+    latchState();
+    do {
+        for(unsigned int i = 0; i < eval_order.size(); i++) {
+            unsigned int gate = eval_order[i];
+            kernels[netlist->type(gate)](values.data(), gate, netlist->faninBegin(gate), netlist->getNumFanin(gate), words);
+        }
+    } while(latchState());
+
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        state_carry[i] = getPatternValue(netlist->getFanin(netlist->getStateVar(i), 0), batch_size - 1);
+    }
+}
+
+//latches every flip flop from its D net, returns true if any latched value changed
+bool ParallelLogicSimulator::latchState() {
+    bool changed = false;
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        unsigned int dff = netlist->getStateVar(i);
+        uint64_t * q = block(dff);
+        const uint64_t * d = block(netlist->getFanin(dff, 0));
+        for(unsigned int rail = 0; rail < 2; rail++) {
+            //pattern p sees the D value from the end of pattern p - 1
+            uint64_t carry = (state_carry[i].val >> rail) & 0x01;
+            for(unsigned int w = rail * words; w < (rail + 1) * words; w++) {
+                uint64_t latched = d[w];
+                if(!latch_same_pattern[i]) {
+                    latched = (d[w] << 1) | carry;
+                    carry = d[w] >> 63;
+                }
+                if(latched != q[w]) {
+                    q[w] = latched;
+                    changed = true;
+                }
             }
         }
-        
-        circuit->setStateGIC();
-        //clear dirty and move on
-        gate_to_eval->resetDirty();
-        gate_to_eval = eventwheel->getNextScheduled();
     }
-    GIC_log.push_back(circuit->calculateGIC());
-    Toggle_log.push_back(circuit->calculateToggle());
+    return changed;
 }
 
+void ParallelLogicSimulator::dumpPO(std::ostream& out_stream, unsigned int pattern) {
+    for(unsigned int i = 0; i < netlist->getNumOutput(); i++) {
+        out_stream << getPatternValue(netlist->getOutput(i), pattern).ascii();
+    }
+    out_stream << std::endl;
+}
+
+void ParallelLogicSimulator::dumpState(std::ostream& out_stream, unsigned int pattern) {
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        out_stream << getPatternValue(netlist->getStateVar(i), pattern).ascii();
+    }
+    out_stream << std::endl;
+}
 
 /****************************************************************************
- * LogicDelaySimulator
+ * PPSFPSimulator
  ****************************************************************************/
-void LogicDelaySimulator::simCycle(const std::vector<char> & input) {
-    if(input.size() != circuit->getNumInput()) {
+
+PPSFPSimulator::PPSFPSimulator(Circuit * ckt) : ParallelLogicSimulator(ckt, PackedKernels::SCALAR), num_queued(0) {
+    observed.assign(netlist->getNumGates(), false);
+    for(unsigned int i = 0; i < netlist->getNumOutput(); i++) {
+        observed[netlist->getOutput(i)] = true;
+    }
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        observed[netlist->getFanin(netlist->getStateVar(i), 0)] = true;
+    }
+    cone.resize(netlist->getNumLevels());
+    queued.assign(netlist->getNumGates(), false);
+
+    //stuck at pins read one of these in place of their fanin
+    tie[0] = netlist->getNumGates();
+    tie[1] = tie[0] + 1;
+    values.push_back(0);
+    values.push_back(0);
+    values.push_back(~0ULL);
+    values.push_back(~0ULL);
+}
+
+void PPSFPSimulator::simBatch(const std::vector<std::vector<char> >& batch) {
+    ParallelLogicSimulator::simBatch(batch);
+    for(unsigned int i = 0; i < circuit->numFaults(); i++) {
+        Fault * flt = circuit->getFault(i);
+        if(flt->isDetected() || flt->isCollapsed()) {
+            continue;
+        }
+        if(propagateFault(*flt)) {
+            std::cerr << flt->faultGateId() << " " << flt->faultGateNet() << " " << flt->faultSA().ascii() << std::endl;
+            flt->setDetected();
+        }
+    }
+    //dropped for the next batches
+    circuit->applyDominance();
+
+    //Calculate Fault Coverage
+    std::cout << "FAULT COV: " << circuit->calculateFaultCov() << std::endl;
+}
+
+//keeps the faulty value just written to gate, if it differs from the good one the fanout cone is scheduled
+void PPSFPSimulator::commitFaulty(unsigned int gate, uint64_t good_lo, uint64_t good_hi, uint64_t & detected) {
+    const uint64_t * val = block(gate);
+    uint64_t diff = (val[0] ^ good_lo) | (val[1] ^ good_hi);
+    if(!diff) {
+        return;
+    }
+    touched.push_back(gate);
+    saved.push_back(good_lo);
+    saved.push_back(good_hi);
+    if(observed[gate]) {
+        detected |= diff & ~PackedLogicValue(val[0], val[1]).isX() & ~PackedLogicValue(good_lo, good_hi).isX();
+    }
+    for(const unsigned int * fout = netlist->fanoutBegin(gate); fout != netlist->fanoutEnd(gate); ++fout) {
+        if(netlist->type(*fout) != Gate::D_FF && !queued[*fout]) {
+            queued[*fout] = true;
+            cone[netlist->getLevel(*fout)].push_back(*fout);
+            num_queued++;
+        }
+    }
+}
+
+//patterns of the batch that detect flt. Faulty values are written over the good ones and put back before returning.
+uint64_t PPSFPSimulator::propagateFault(const Fault& flt) {
+    unsigned int gate = netlist->getIndex(flt.faultGateId());
+    unsigned int net = flt.faultGateNet();
+    unsigned int sa = tie[flt.faultSA() == LogicValue::ONE];
+    uint64_t * val = block(gate);
+    uint64_t good_lo = val[0];
+    uint64_t good_hi = val[1];
+    uint64_t detected = 0;
+
+    if(net == 0) {
+        val[0] = block(sa)[0];
+        val[1] = block(sa)[1];
+        commitFaulty(gate, good_lo, good_hi, detected);
+    } else if(netlist->type(gate) == Gate::D_FF) {
+        //the scan cell captures the stuck D pin, nothing to propagate
+        const uint64_t * d = block(netlist->getFanin(gate, 0));
+        PackedLogicValue good(d[0], d[1]);
+        PackedLogicValue faulty(block(sa)[0], block(sa)[1]);
+        detected = ((good.lo ^ faulty.lo) | (good.hi ^ faulty.hi)) & ~good.isX();
+    } else {
+        pin_fanin.assign(netlist->faninBegin(gate), netlist->faninEnd(gate));
+        pin_fanin[net - 1] = sa;
+        kernels[netlist->type(gate)](values.data(), gate, pin_fanin.data(), pin_fanin.size(), words);
+        commitFaulty(gate, good_lo, good_hi, detected);
+    }
+
+    uint64_t pattern_mask = (batch_size < PPSFP_WIDTH) ? ((1ULL << batch_size) - 1) : ~0ULL;
+    for(unsigned int level = netlist->getLevel(gate); num_queued; level++) {
+        std::vector<unsigned int>& pending = cone[level];
+        for(unsigned int i = 0; i < pending.size(); i++) {
+            unsigned int fout = pending[i];
+            queued[fout] = false;
+            num_queued--;
+            //a detected fault is dropped, the rest of the cone is only unscheduled
+            if(detected & pattern_mask) {
+                continue;
+            }
+            const uint64_t * fval = block(fout);
+            uint64_t fout_lo = fval[0];
+            uint64_t fout_hi = fval[1];
+            kernels[netlist->type(fout)](values.data(), fout, netlist->faninBegin(fout), netlist->getNumFanin(fout), words);
+            commitFaulty(fout, fout_lo, fout_hi, detected);
+        }
+        pending.clear();
+    }
+
+    for(unsigned int i = 0; i < touched.size(); i++) {
+        uint64_t * restore = block(touched[i]);
+        restore[0] = saved[2 * i];
+        restore[1] = saved[2 * i + 1];
+    }
+    touched.clear();
+    saved.clear();
+    return detected & pattern_mask;
+}
+
+/****************************************************************************
+ * CompiledSimulator
+ ****************************************************************************/
+
+CompiledSimulator::CompiledSimulator(Circuit * ckt, const std::string& name) : Simulator(ckt), netlist(ckt->getNetlist()) {
+    compiled = new CompiledCircuit(netlist, name);
+    values.assign(netlist->getNumGates(), LogicValue::X);
+}
+
+void CompiledSimulator::simCycle(const std::vector<char>& input) {
+    if(input.size() != netlist->getNumInput()) {
         std::cerr << "INVALID INPUT AT: " << cycle_id << std::endl;
     }
-    for(unsigned int i = 0; i < input.size(); i++) { //insert all inputs as events
-        InputGate * in = circuit->getInput(i);
-        if(in) {
-            in->setInput(LogicValue::fromChar(input[i]));
-            eventwheel->insertEvent(in);
-        } else {
-            std::cerr << "INVALID INPUT GATE: CKT ERROR" << std::endl;
-            exit(-1);
+    for(unsigned int i = 0; i < input.size(); i++) {
+        values[netlist->getInput(i)] = LogicValue::fromChar(input[i]).val;
+    }
+    compiled->simCycle(values.data());
+}
+
+/****************************************************************************
+ * LogicDelaySimulator
+ ****************************************************************************/
+LogicDelaySimulator::LogicDelaySimulator(Circuit * ckt, DelayModel model) : Simulator(ckt), netlist(ckt->getNetlist()),
+    initialized(false), model(model)
+{
+    eventwheel = new GateDelayWheel();
+    state_pos.assign(netlist->getNumGates(), 0);
+    for(unsigned int i = 0; i < netlist->getNumStateVar(); i++) {
+        state_pos[netlist->getStateVar(i)] = i;
+    }
+    projected.resize(netlist->getNumGates());
+    for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+        projected[i] = netlist->getValue(i).val;
+    }
+    pending_event.assign(netlist->getNumGates(), GateDelayWheel::NO_EVENT);
+    pending_time.assign(netlist->getNumGates(), 0);
+    prior = projected;
+    transitions.assign(netlist->getNumGates(), 0);
+    glitches.assign(netlist->getNumGates(), 0);
+    cycle_count.assign(netlist->getNumGates(), 0);
+    cycle_start.resize(netlist->getNumGates());
+    if(ckt->hasCapacitance()) {
+        capacitance.resize(netlist->getNumGates());
+        for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+            capacitance[i] = ckt->getCapacitance(netlist->getGateId(i));
         }
     }
-    if(cycle_id % 500 == 0) std::cerr << cycle_id <<std::endl;
-    //always schedule all state vars (there are some optimizations possible, but this is easiest for now)
-    for(unsigned int i = 0; i<circuit->getNumStateVar(); i++) {
-        //inject X_ids
+}
 
-        eventwheel->insertEvent(circuit->getStateVar(i));
+//folds the transitions of this cycle into the per gate glitch counts and the per cycle totals
+void LogicDelaySimulator::closeCycleActivity() {
+    unsigned int total = 0;
+    double switched_cap = 0.0;
+    for(unsigned int i = 0; i < switched.size(); i++) {
+        unsigned int gate = switched[i];
+        unsigned int count = cycle_count[gate];
+        glitches[gate] += count - ((netlist->getValue(gate).val != cycle_start[gate]) ? 1 : 0);
+        total += count;
+        if(!capacitance.empty()) {
+            switched_cap += count * capacitance[gate];
+        }
+        cycle_count[gate] = 0;
     }
+    switched.clear();
+    cycle_transitions.push_back(total);
+    if(!capacitance.empty()) {
+        cycle_switched_cap.push_back(switched_cap);
+    }
+}
 
-    Gate * gate_to_eval = eventwheel->getNextScheduled();
-    while (gate_to_eval != NULL) {
-        gate_to_eval->evaluate();
-        if(!gate_to_eval->isDirty()) {
-            gate_to_eval = eventwheel->getNextScheduled();
+double LogicDelaySimulator::estimatePower(double vdd, double freq) const {
+    if(cycle_switched_cap.empty()) {
+        return 0.0;
+    }
+    double switched_cap = 0.0;
+    for(unsigned int i = 0; i < cycle_switched_cap.size(); i++) {
+        switched_cap += cycle_switched_cap[i];
+    }
+    return 0.5 * vdd * vdd * freq * switched_cap / cycle_switched_cap.size();
+}
+
+void LogicDelaySimulator::dumpActivity(std::ostream& out_stream) {
+    for(unsigned int gate_id = 1; gate_id <= netlist->getNumGates(); gate_id++) {
+        unsigned int gate = netlist->getIndex(gate_id);
+        out_stream << gate_id << "," << transitions[gate] << "," << glitches[gate];
+        if(!capacitance.empty()) {
+            out_stream << "," << transitions[gate] * capacitance[gate];
+        }
+        out_stream << std::endl;
+    }
+}
+
+void LogicDelaySimulator::dumpCycleActivity(std::ostream& out_stream) {
+    for(unsigned int i = 0; i < cycle_transitions.size(); i++) {
+        out_stream << cycle_transitions[i];
+        if(!capacitance.empty()) {
+            out_stream << "," << cycle_switched_cap[i];
+        }
+        out_stream << std::endl;
+    }
+}
+
+//schedules the output transitions caused by a change of gate
+void LogicDelaySimulator::scheduleFanouts(unsigned int gate) {
+    for(const unsigned int * fout = netlist->fanoutBegin(gate); fout != netlist->fanoutEnd(gate); ++fout) {
+        if(netlist->type(*fout) == Gate::D_FF) {
+            if(netlist->type(gate) != Gate::INPUT) { //PI fed flip flops were scheduled with the PI
+                pending_state.insert(state_pos[*fout]);
+            }
             continue;
         }
+        LogicValue val = netlist->computeValue(*fout);
+        if(pending_event[*fout] != GateDelayWheel::NO_EVENT) {
+            if(model == INERTIAL) {
+                if(val.val == projected[*fout]) {
+                    continue; //the pending transition already goes to val, it keeps its time
+                }
+                eventwheel->cancelEvent(pending_event[*fout]);
+                pending_event[*fout] = GateDelayWheel::NO_EVENT;
+                projected[*fout] = netlist->getValue(*fout).val;
+            } else if(val.val != projected[*fout] &&
+                      pending_time[*fout] > eventwheel->getCurrentTime() + netlist->getDelay(*fout, val)) {
+                //with unequal rise and fall delays a transition can land before the last one scheduled,
+                //which is then removed as a transport delay line would
+                eventwheel->cancelEvent(pending_event[*fout]);
+                pending_event[*fout] = GateDelayWheel::NO_EVENT;
+                projected[*fout] = prior[*fout];
+            }
+        }
+        if(val.val == projected[*fout]) {
+            continue;
+        }
+        unsigned int delay = netlist->getDelay(*fout, val);
+        pending_event[*fout] = eventwheel->insertEvent(*fout, delay, val);
+        pending_time[*fout] = eventwheel->getCurrentTime() + delay;
+        prior[*fout] = projected[*fout];
+        projected[*fout] = val.val;
+    }
+}
 
-        for(unsigned int i = 0; i<gate_to_eval->getNumFanout(); i++) {
-            if(gate_to_eval->getFanout(i)->type() != Gate::D_FF) {
-                eventwheel->insertEvent(gate_to_eval->getFanout(i));
+void LogicDelaySimulator::simCycle(const std::vector<char> & input) {
+    if(input.size() != netlist->getNumInput()) {
+        std::cerr << "INVALID INPUT AT: " << cycle_id << std::endl;
+    }
+    if(!initialized) {
+        pending_state.assign(netlist->getNumStateVar(), true);
+    }
+    for(unsigned int i = 0; i < input.size(); i++) { //insert the inputs that changed as events
+        unsigned int in = netlist->getInput(i);
+        LogicValue val = LogicValue::fromChar(input[i]);
+        if(val == netlist->getValue(in) && initialized) {
+            continue;
+        }
+        if(val != netlist->getValue(in)) {
+            recordTransition(in, netlist->getValue(in));
+        }
+        netlist->setValue(in, val);
+        eventwheel->insertEvent(in, netlist->getDelay(in, val));
+        markPending(in);
+    }
+    initialized = true;
+    if(cycle_id % 500 == 0) std::cerr << cycle_id <<std::endl;
+    cycle_id++;
+
+    //pending flip flops in state var order latch their D net at the clock edge, the new value is applied
+    //after the rise or fall delay of the flip flop. One fed by an earlier flip flop sees the value that one
+    //latched this cycle, so it is rechecked whenever its driver changes.
+    for(unsigned int pos = pending_state.next(0); pos != StateVarSet::END; pos = pending_state.next(pos + 1)) {
+        pending_state.erase(pos);
+        unsigned int dff = netlist->getStateVar(pos);
+        unsigned int d = netlist->getFanin(dff, 0);
+        LogicValue val = (netlist->type(d) == Gate::D_FF) ? LogicValue(LogicValue::VALUES(projected[d])) : netlist->getValue(d);
+        if(val.val == projected[dff]) {
+            continue;
+        }
+        projected[dff] = val.val;
+        eventwheel->insertEvent(dff, netlist->getDelay(dff, val), val);
+        for(const unsigned int * fout = netlist->fanoutBegin(dff); fout != netlist->fanoutEnd(dff); ++fout) {
+            if(netlist->type(*fout) == Gate::D_FF && state_pos[*fout] > pos) {
+                pending_state.insert(state_pos[*fout]);
             }
         }
+    }
 
-        //clear dirty and move on
-        gate_to_eval->resetDirty();
-        gate_to_eval = eventwheel->getNextScheduled();
+    unsigned int gate = eventwheel->getNextScheduled();
+    while (gate != GateDelayWheel::NO_EVENT) {
+        bool changed = true; //PI values were set at the start of the cycle
+        if(netlist->type(gate) != Gate::INPUT) {
+            if(model == INERTIAL) {
+                pending_event[gate] = GateDelayWheel::NO_EVENT;
+            }
+            LogicValue previous = netlist->getValue(gate);
+            changed = netlist->commitValue(gate, eventwheel->getEventValue());
+            if(changed) {
+                recordTransition(gate, previous);
+            }
+        }
+        if(changed) {
+            scheduleFanouts(gate);
+        }
+        gate = eventwheel->getNextScheduled();
     }
+    closeCycleActivity();
 }
 
 /****************************************************************************
  * FaultSimulator
  ****************************************************************************/
+FaultSimulator::FaultSimulator(Circuit * ckt, unsigned int group_width, unsigned int num_threads) : Simulator(ckt), initialized(false),
+    pool_cycle(0), pool_running(0), pool_exit(false)
+{
+    eventwheel = new EventWheel(ckt->getLevelSizes(), ckt->getNumGates());
+    state_pos.assign(ckt->getNumGates() + 1, 0);
+    for(unsigned int i = 0; i < ckt->getNumStateVar(); i++) {
+        state_pos[ckt->getStateVar(i)->getId()] = i;
+    }
+    if(num_threads == 0) {
+        num_threads = 1;
+    }
+    for(unsigned int i = 0; i < num_threads; i++) {
+        workers.push_back(new FaultWorker(ckt, group_width));
+    }
+    for(unsigned int i = 1; i < num_threads; i++) {
+        threads.push_back(std::thread(&FaultSimulator::runThread, this, i));
+    }
+}
+
+FaultSimulator::~FaultSimulator() {
+    {
+        std::lock_guard<std::mutex> guard(pool_lock);
+        pool_exit = true;
+    }
+    pool_start.notify_all();
+    for(unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    for(unsigned int i = 0; i < workers.size(); i++) {
+        delete workers[i];
+    }
+    delete eventwheel;
+}
+
 void FaultSimulator::simCycle(const std::vector<char>& input) {
     //check if input is correct size
     if(input.size() != circuit->getNumInput()) {
         std::cerr << "INVALID INPUT AT: " << cycle_id << std::endl;
     }
-    for(unsigned int i = 0; i < input.size(); i++) { //insert all inputs as events
+    changed_inputs.clear();
+    for(unsigned int i = 0; i < input.size(); i++) {
         InputGate * in = circuit->getInput(i);
         if(in) {
-            in->setInput(LogicValue::fromChar(input[i]));
-            eventwheel->insertEvent(in);
+            //first cycle propagates every PI so gates next to tie cells get a value
+            if(in->setInput(LogicValue::fromChar(input[i])) || !initialized) {
+                changed_inputs.push_back(in);
+            }
         } else {
             std::cerr << "INVALID INPUT GATE: CKT ERROR" << std::endl;
             exit(-1);
         }
     }
-    
-    //always schedule all state vars (there are some optimizations possible, but this is easiest for now)
-    for(unsigned int i = 0; i<circuit->getNumStateVar(); i++) {
-        eventwheel->insertEvent(circuit->getStateVar(i));
+    if(!initialized) {
+        pending_state.assign(circuit->getNumStateVar(), true);
+        initialized = true;
     }
+    latchState();
     
     //goodsim
     //std::cerr << "GOODSIM" << std::endl;
     simGoodEvents();
     
     
-    //faultsim
+    //faultsim, gate outputs stay as they are until the next cycle
     circuit->resetInjection();
     //std::cerr << "FAULTSIM" << std::endl;
-    std::vector<Gate*> injected;
-    circuit->injectFaults(injected);
-    while(!injected.empty()){
-        for(unsigned int i = 0; i < injected.size(); i++){
-            eventwheel->insertEvent(injected[i]);
+    unsigned int width = workers[0]->group->getWidth();
+    unsigned int num_groups = (circuit->numActiveFaults() + width - 1) / width;
+    for(unsigned int i = 0; i < workers.size(); i++) {
+        workers[i]->first_group = (uint64_t) num_groups * i / workers.size();
+        workers[i]->last_group = (uint64_t) num_groups * (i + 1) / workers.size();
+    }
+    if(!threads.empty()) {
+        std::lock_guard<std::mutex> guard(pool_lock);
+        pool_cycle++;
+        pool_running = threads.size();
+        pool_start.notify_all();
+    }
+    simFaultGroups(0);
+    if(!threads.empty()) {
+        std::unique_lock<std::mutex> guard(pool_lock);
+        while(pool_running) {
+            pool_done.wait(guard);
         }
-        simFaultyEvents();
-        circuit->invalidateFaultArrays();
-        injected.clear();
-        circuit->injectFaults(injected);
     }
+    mergeDetections();
     
     //Calculate Fault Coverage
     std::cout << "FAULT COV: " << circuit->calculateFaultCov() << std::endl;
 }
 
+//same order as the event wheel at level 0: PIs first, then flip flops in state var order. A flip flop fed
+//by a PI or an earlier flip flop sees its value from this cycle.
+void FaultSimulator::latchState() {
+    for(unsigned int i = 0; i < changed_inputs.size(); i++) {
+        propagate(changed_inputs[i]);
+    }
+    for(unsigned int pos = pending_state.next(0); pos != StateVarSet::END; pos = pending_state.next(pos + 1)) {
+        pending_state.erase(pos);
+        Gate * dff = circuit->getStateVar(pos);
+        dff->evaluateByType();
+        if(dff->isDirty()) {
+            propagate(dff);
+            dff->resetDirty();
+        }
+    }
+}
+
 void FaultSimulator::simGoodEvents(){
-    Gate * gate_to_eval = eventwheel->getNextScheduled();
-    while (gate_to_eval != NULL) {
-        gate_to_eval->evaluate();
+    unsigned int gate_idx = eventwheel->getNextScheduled();
+    while (gate_idx != EventWheel::NO_EVENT) {
+        Gate * gate_to_eval = circuit->getGateById(gate_idx + 1);
+        gate_to_eval->evaluateByType();
         if(!gate_to_eval->isDirty()) {
-            gate_to_eval = eventwheel->getNextScheduled();
+            gate_idx = eventwheel->getNextScheduled();
             continue;
         }
         
-        for(unsigned int i = 0; i<gate_to_eval->getNumFanout(); i++) {
-            if(gate_to_eval->getFanout(i)->type() != Gate::D_FF) {
-                eventwheel->insertEvent(gate_to_eval->getFanout(i));
-            }
-        }
+        propagate(gate_to_eval);
         
         //clear dirty and move on
         gate_to_eval->resetDirty();
-        gate_to_eval = eventwheel->getNextScheduled();
+        gate_idx = eventwheel->getNextScheduled();
+    }
+}
+
+//worker threads sleep between cycles
+void FaultSimulator::runThread(unsigned int id) {
+    unsigned int cycle = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> guard(pool_lock);
+            while(!pool_exit && pool_cycle == cycle) {
+                pool_start.wait(guard);
+            }
+            if(pool_exit) {
+                return;
+            }
+            cycle = pool_cycle;
+        }
+        simFaultGroups(id);
+        std::lock_guard<std::mutex> guard(pool_lock);
+        if(--pool_running == 0) {
+            pool_done.notify_one();
+        }
+    }
+}
+
+//next group of worker id, stolen from another worker once its own are done. Returns false when no group is left.
+bool FaultSimulator::claimGroup(unsigned int id, unsigned int & group_idx) {
+    FaultWorker & worker = *workers[id];
+    {
+        std::lock_guard<std::mutex> guard(worker.lock);
+        if(worker.first_group != worker.last_group) {
+            group_idx = worker.first_group++;
+            return true;
+        }
+    }
+    for(unsigned int i = 1; i < workers.size(); i++) {
+        FaultWorker & victim = *workers[(id + i) % workers.size()];
+        unsigned int first;
+        unsigned int last;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if(victim.first_group == victim.last_group) {
+                continue;
+            }
+            first = victim.first_group + (victim.last_group - victim.first_group) / 2;
+            last = victim.last_group;
+            victim.last_group = first;
+        }
+        std::lock_guard<std::mutex> guard(worker.lock);
+        group_idx = first;
+        worker.first_group = first + 1;
+        worker.last_group = last;
+        return true;
     }
+    return false;
 }
 
-void FaultSimulator::simFaultyEvents(){
-    Gate * gate_to_eval = eventwheel->getNextScheduled();
-    while (gate_to_eval != NULL) {
-        gate_to_eval->faultEvaluate();
-        if(!gate_to_eval->propagatesFault()) {
-            gate_to_eval = eventwheel->getNextScheduled();
+void FaultSimulator::simFaultGroups(unsigned int id) {
+    FaultWorker & worker = *workers[id];
+    unsigned int width = worker.group->getWidth();
+    unsigned int group_idx;
+    while(claimGroup(id, group_idx)) {
+        size_t first = (size_t) group_idx * width;
+        circuit->injectFaults(*worker.group, worker.injected, first, std::min(first + width, circuit->numActiveFaults()));
+        for(unsigned int i = 0; i < worker.injected.size(); i++) {
+            worker.eventwheel->insertEvent(worker.injected[i]->getId() - 1, worker.injected[i]->getLevel());
+        }
+        simFaultyEvents(worker);
+        for(unsigned int word = 0; word < worker.group->getNumWords(); word++) {
+            for(uint64_t rest = worker.group->getDetected(word); rest; rest &= rest - 1) {
+                worker.detections.push_back(worker.group->getFault((word << 6) + __builtin_ctzll(rest)));
+            }
+        }
+        worker.group->clear();
+        worker.injected.clear();
+    }
+}
+
+void FaultSimulator::simFaultyEvents(FaultWorker & worker){
+    unsigned int gate_idx = worker.eventwheel->getNextScheduled();
+    while (gate_idx != EventWheel::NO_EVENT) {
+        Gate * gate_to_eval = circuit->getGateById(gate_idx + 1);
+        if(!gate_to_eval->faultEvaluateByType(*worker.group)) {
+            gate_idx = worker.eventwheel->getNextScheduled();
             continue;
         }
         
         for(unsigned int i = 0; i<gate_to_eval->getNumFanout(); i++) {
             if(gate_to_eval->getFanout(i)->type() != Gate::D_FF) {
-                eventwheel->insertEvent(gate_to_eval->getFanout(i));
+                worker.eventwheel->insertEvent(gate_to_eval->getFanout(i)->getId() - 1, gate_to_eval->getFanout(i)->getLevel());
             }
         }
-        
-        //clear dirty and move on
-        gate_to_eval->resetDirty();
-        gate_to_eval = eventwheel->getNextScheduled();
+        gate_idx = worker.eventwheel->getNextScheduled();
+    }
+}
+
+//in fault list order, so the report does not depend on which worker simulated a fault
+void FaultSimulator::mergeDetections() {
+    std::vector<Fault *> detected;
+    for(unsigned int i = 0; i < workers.size(); i++) {
+        detected.insert(detected.end(), workers[i]->detections.begin(), workers[i]->detections.end());
+        workers[i]->detections.clear();
+    }
+    std::sort(detected.begin(), detected.end());
+    for(unsigned int i = 0; i < detected.size(); i++) {
+        Fault * flt = detected[i];
+        if(!flt->isDetected()) {
+            std::cerr << flt->faultGateId() << " " << flt->faultGateNet() << " " << flt->faultSA().ascii() << std::endl;
+        }
+        flt->setDetected();
     }
 }
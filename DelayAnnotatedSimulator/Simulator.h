@@ -29,12 +29,54 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "EventWheel.h"
 #include "Circuit.h"
+#include "FlatNetlist.h"
+#include "PackedKernels.h"
+#include "CompiledCircuit.h"
 #include "Gates.h"
 #include "Args.h"
 #include "Type.h"
 
+//Flip flops waiting to latch, by state var position. Iterated in position order; positions after
+//the one being visited may be added during the walk and are visited in the same pass.
+class StateVarSet {
+private:
+    std::vector<uint64_t> bits;
+public:
+    static const unsigned int END = 0xFFFFFFFF;
+    inline void assign(size_t num_state_vars, bool all) {
+        bits.assign((num_state_vars + 63) / 64, all ? ~uint64_t(0) : 0);
+        if(all && (num_state_vars & 63)) {
+            bits.back() = (uint64_t(1) << (num_state_vars & 63)) - 1;
+        }
+    }
+    inline void insert(unsigned int pos) {
+        bits[pos >> 6] |= (uint64_t(1) << (pos & 63));
+    }
+    inline void erase(unsigned int pos) {
+        bits[pos >> 6] &= ~(uint64_t(1) << (pos & 63));
+    }
+    //first position >= pos in the set, END if there is none
+    inline unsigned int next(unsigned int pos) const {
+        unsigned int word = pos >> 6;
+        if(word >= bits.size()) {
+            return END;
+        }
+        uint64_t rest = bits[word] & (~uint64_t(0) << (pos & 63));
+        while(rest == 0) {
+            if(++word == bits.size()) {
+                return END;
+            }
+            rest = bits[word];
+        }
+        return (word << 6) + __builtin_ctzll(rest);
+    }
+};
+
 //Base class for simulators. Will be used for LogicSimulator, FaultSimulator, DelaySimulator.
 class Simulator {
 protected:
@@ -42,6 +84,14 @@ protected:
     unsigned int cycle_id;
     std::vector<double> GIC_log;
     std::vector<double> Toggle_log;
+
+    //value lookups for the dump methods, simulators running off the FlatNetlist override these.
+    virtual LogicValue getPOValue(unsigned int idx) {
+        return circuit->getOutput(idx)->getOut();
+    }
+    virtual LogicValue getStateValue(unsigned int idx) {
+        return circuit->getStateVar(idx)->getOut();
+    }
 public:
     Simulator(Circuit * ckt) : circuit(ckt), cycle_id(0) {}
     virtual ~Simulator() {}
@@ -55,45 +105,341 @@ public:
 //this simulator simCycle simulates the positive edge.
 //Therefore, flip flops latch in at the beginning of simCycle.
 
+//activity is events (gate evaluations the event wheel would do) per gate per cycle, averaged over
+//ACTIVITY_WINDOW cycles. Above the first threshold LogicSimulator sweeps every gate in level order,
+//below the second it goes back to the event wheel.
+#define OBLIVIOUS_ENTER_ACTIVITY 0.35
+#define OBLIVIOUS_EXIT_ACTIVITY 0.20
+#define ACTIVITY_WINDOW 32
+
 class LogicSimulator: public Simulator {
-    EventWheel * eventwheel;
 public:
-    LogicSimulator(Circuit * ckt): Simulator(ckt) {
-        eventwheel = new EventWheel(ckt->getNumLevels());
+    enum Engine {
+        AUTO = 0,     //switch on measured activity
+        EVENT_DRIVEN, //event wheel only
+        OBLIVIOUS     //levelized sweep only
+    };
+private:
+    FlatNetlist * netlist;
+    EventWheel * eventwheel;
+    bool initialized; //first cycle evaluates every gate so tie cells and their cones get values
+
+    //only PIs that changed and flip flops whose D net changed since they last latched are evaluated
+    std::vector<unsigned int> changed_inputs;
+    std::vector<unsigned int> state_pos; //state var position of each flip flop, by gate
+    StateVarSet pending_state;
+    bool last_calc_GIC;
+
+    Engine engine;
+    bool sweeping;
+    std::vector<unsigned int> sweep_order; //gates other than PIs and flip flops, by level
+    std::vector<unsigned char> touched;    //gate would have been scheduled this cycle, keeps GIC the same in both engines
+    unsigned long window_events;
+    unsigned int window_cycles;
+
+    unsigned int latchState(bool calc_GIC);
+    unsigned int eventCycle(bool calc_GIC);
+    unsigned int evaluateRegion(unsigned int root, bool calc_GIC);
+    unsigned int sweepCycle(bool calc_GIC);
+    void selectEngine(unsigned int events);
+    inline void scheduleRegion(unsigned int gate) {
+        unsigned int root = netlist->getRegionRoot(gate);
+        eventwheel->insertEvent(root, netlist->getLevel(root));
+    }
+    //marks the fanouts of a gate whose output changed. Flip flops latch at the next pending pass, other
+    //gates are touched and, with the event engine, their region is scheduled unless it is the caller's.
+    inline void propagate(unsigned int gate, unsigned int root) {
+        for(const unsigned int * fout = netlist->fanoutBegin(gate); fout != netlist->fanoutEnd(gate); ++fout) {
+            if(netlist->type(*fout) == Gate::D_FF) {
+                pending_state.insert(state_pos[*fout]);
+                continue;
+            }
+            touched[*fout] = 1;
+            if(!sweeping && netlist->getRegionRoot(*fout) != root) {
+                scheduleRegion(*fout);
+            }
+        }
+    }
+protected:
+    LogicValue getPOValue(unsigned int idx) {
+        return netlist->getValue(netlist->getOutput(idx));
     }
+    LogicValue getStateValue(unsigned int idx) {
+        return netlist->getValue(netlist->getStateVar(idx));
+    }
+public:
+    LogicSimulator(Circuit * ckt, Engine engine = AUTO);
     ~LogicSimulator() {
         delete eventwheel;
     }
+    inline bool isSweeping() const {
+        return sweeping;
+    }
+    void simCycle(const std::vector<char>&);
+};
+
+//PARALLEL PATTERN LOGIC
+//Simulates a batch of consecutive vectors per pass, one per bit of the dual-rail value blocks
+//(see PackedKernels.h), with a levelized sweep instead of the event wheel. A batch is 64 patterns
+//per vector register word: 64 scalar, 256 with AVX2, 512 with AVX-512, picked by CPUID.
+//Flip flops latch the previous pattern's D value, so for sequential circuits the sweep is repeated
+//until the latched state stops changing; the result is the same as simulating the vectors one at a
+//time. Combinational circuits need a single pass.
+class ParallelLogicSimulator: public Simulator {
+protected:
+    FlatNetlist * netlist;
+    PackedKernels::ISA isa;
+    const PackedKernel * kernels;
+    unsigned int words;                   //uint64_t per rail per gate
+    std::vector<unsigned int> eval_order; //combinational gates by level
+    std::vector<uint64_t> values;
+    std::vector<LogicValue> state_carry;  //D value of each flip flop after the last pattern of the previous batch
+    std::vector<bool> latch_same_pattern; //flip flop samples a gate already updated this cycle (PI or earlier FF)
+    unsigned int batch_size;
+
+    inline uint64_t * block(unsigned int gate) {
+        return values.data() + (size_t) gate * 2 * words;
+    }
+    LogicValue getPatternValue(unsigned int gate, unsigned int pattern) const;
+    void setPatternValue(unsigned int gate, unsigned int pattern, LogicValue val);
+    bool latchState();
+    LogicValue getPOValue(unsigned int idx) {
+        return getPatternValue(netlist->getOutput(idx), batch_size - 1);
+    }
+    LogicValue getStateValue(unsigned int idx) {
+        return getPatternValue(netlist->getStateVar(idx), batch_size - 1);
+    }
+public:
+    ParallelLogicSimulator(Circuit * ckt, PackedKernels::ISA isa = PackedKernels::detect());
+    ~ParallelLogicSimulator() {}
+    inline PackedKernels::ISA getISA() const {
+        return isa;
+    }
+    //max vectors per simBatch
+    inline unsigned int getBatchCapacity() const {
+        return words * 64;
+    }
+    void simCycle(const std::vector<char>&);
+    virtual void simBatch(const std::vector<std::vector<char> >&);
+    void dumpPO(std::ostream&, unsigned int pattern);
+    void dumpState(std::ostream&, unsigned int pattern);
+    using Simulator::dumpPO;
+    using Simulator::dumpState;
+};
+
+//PARALLEL PATTERN SINGLE FAULT PROPAGATION
+//Full scan stuck at fault simulation: flip flop outputs are pseudo inputs and their D nets pseudo outputs.
+//The good machine is the ParallelLogicSimulator on the scalar kernels, 64 patterns per batch, and the state
+//scanned in for a pattern is the one the good machine reached before it. Faulty state never carries over
+//to the next pattern. Each undetected fault is then propagated alone through its fanout cone, 64 patterns
+//wide, and dropped once detected at a PO or a D net. Coverage is Circuit::calculateFaultCov.
+#define PPSFP_WIDTH 64
+
+class PPSFPSimulator: public ParallelLogicSimulator {
+    std::vector<bool> observed;                   //PO or D net of a flip flop
+    std::vector<std::vector<unsigned int> > cone; //gates waiting for faulty evaluation, by level
+    std::vector<bool> queued;
+    unsigned int num_queued;
+    std::vector<unsigned int> touched; //gates holding a faulty value
+    std::vector<uint64_t> saved;       //good lo/hi words of the touched gates
+    std::vector<unsigned int> pin_fanin; //fanins of the faulty gate with the faulty pin tied off
+    unsigned int tie[2];               //constant ZERO and ONE blocks placed after the last gate
+
+    void commitFaulty(unsigned int gate, uint64_t good_lo, uint64_t good_hi, uint64_t & detected);
+    uint64_t propagateFault(const Fault& flt);
+public:
+    PPSFPSimulator(Circuit * ckt);
+    ~PPSFPSimulator() {}
+    void simBatch(const std::vector<std::vector<char> >&);
+};
+
+//COMPILED CODE
+//Runs the straight-line code generated by CompiledCircuit. Every gate is evaluated every cycle in
+//the same order as the event wheel would, so the results match LogicSimulator. No GIC/toggle logging.
+class CompiledSimulator: public Simulator {
+    FlatNetlist * netlist;
+    CompiledCircuit * compiled;
+    std::vector<unsigned char> values; //LogicValue::VALUES, indexed like the FlatNetlist
+protected:
+    LogicValue getPOValue(unsigned int idx) {
+        return LogicValue(LogicValue::VALUES(values[netlist->getOutput(idx)]));
+    }
+    LogicValue getStateValue(unsigned int idx) {
+        return LogicValue(LogicValue::VALUES(values[netlist->getStateVar(idx)]));
+    }
+public:
+    CompiledSimulator(Circuit * ckt, const std::string& name);
+    ~CompiledSimulator() {
+        delete compiled;
+    }
     void simCycle(const std::vector<char>&);
 };
 
 //LOGIC DELAY
+//PIs and flip flops are evaluated when their event comes up, combinational gates compute their new
+//output when a fanin changes and the wheel applies it after the gate delay.
 class LogicDelaySimulator: public Simulator {
+public:
+    enum DelayModel {
+        TRANSPORT = 0, //every output transition is applied after the gate delay
+        INERTIAL       //a new transition replaces the pending one, pulses shorter than the delay never reach the output
+    };
+private:
+    FlatNetlist * netlist;
     GateDelayWheel * eventwheel;
     std::vector<unsigned int> output_time;
-public:
-    LogicDelaySimulator(Circuit * ckt): Simulator(ckt) {
-        eventwheel = new GateDelayWheel(ckt->getMaxDelay());
+    bool initialized;
+    DelayModel model;
+
+    //value a gate takes once its scheduled transitions are applied. For combinational gates the last
+    //transition scheduled: its handle (NO_EVENT if none), time and the projected value before it.
+    //In inertial mode the handle is cleared once the transition is applied, in transport mode the
+    //time tells whether it is still pending.
+    std::vector<unsigned char> projected;
+    std::vector<unsigned int> pending_event;
+    std::vector<uint64_t> pending_time;
+    std::vector<unsigned char> prior;
+
+    //only PIs that changed and flip flops whose D net changed since they last latched are scheduled
+    std::vector<unsigned int> state_pos; //state var position of each flip flop, by gate
+    StateVarSet pending_state;
+
+    //switching activity, by gate: every applied output value change, glitches included, and the ones
+    //that did not survive to the end of their cycle
+    std::vector<unsigned int> transitions;
+    std::vector<unsigned int> glitches;
+    std::vector<double> capacitance; //by gate, from Circuit::readCapacitance, empty without a cap file
+    //gates that switched this cycle, their transitions this cycle and their value at the start of it
+    std::vector<unsigned int> switched;
+    std::vector<unsigned int> cycle_count;
+    std::vector<unsigned char> cycle_start;
+    //by cycle
+    std::vector<unsigned int> cycle_transitions;
+    std::vector<double> cycle_switched_cap;
+
+    void scheduleFanouts(unsigned int gate);
+    void closeCycleActivity();
+    inline void markPending(unsigned int gate) {
+        for(const unsigned int * fout = netlist->fanoutBegin(gate); fout != netlist->fanoutEnd(gate); ++fout) {
+            if(netlist->type(*fout) == Gate::D_FF) {
+                pending_state.insert(state_pos[*fout]);
+            }
+        }
+    }
+    inline void recordTransition(unsigned int gate, LogicValue previous) {
+        if(cycle_count[gate]++ == 0) {
+            switched.push_back(gate);
+            cycle_start[gate] = previous.val;
+        }
+        transitions[gate]++;
     }
+protected:
+    LogicValue getPOValue(unsigned int idx) {
+        return netlist->getValue(netlist->getOutput(idx));
+    }
+    LogicValue getStateValue(unsigned int idx) {
+        return netlist->getValue(netlist->getStateVar(idx));
+    }
+public:
+    LogicDelaySimulator(Circuit * ckt, DelayModel model = TRANSPORT);
     ~LogicDelaySimulator() {
         delete eventwheel;
     }
     void simCycle(const std::vector<char>&);
+
+    inline unsigned int getTransitions(unsigned int gate_id) const {
+        return transitions[netlist->getIndex(gate_id)];
+    }
+    inline unsigned int getGlitches(unsigned int gate_id) const {
+        return glitches[netlist->getIndex(gate_id)];
+    }
+    inline const std::vector<unsigned int> & getCycleTransitions() const {
+        return cycle_transitions;
+    }
+    //sum of the capacitance switched by each transition, by cycle. Empty without a cap file.
+    inline const std::vector<double> & getCycleSwitchedCap() const {
+        return cycle_switched_cap;
+    }
+    //average dynamic power over the cycles simulated, 1/2 * C * vdd^2 per transition at freq cycles per second
+    double estimatePower(double vdd, double freq) const;
+    //csv, one line per gate: "GateId, Transitions, Glitches[, SwitchedCap]"
+    void dumpActivity(std::ostream&);
+    //csv, one line per cycle: "Transitions[, SwitchedCap]"
+    void dumpCycleActivity(std::ostream&);
 };
 
 //FAULT SIM
-class FaultSimulator : public Simulator{
-    EventWheel * eventwheel;
+//Faulty machine of one fault simulation thread: private event wheel and fault group, plus the faults
+//its groups detected this cycle, merged by the FaultSimulator once every worker is done.
+class FaultWorker {
 public:
-    FaultSimulator(Circuit * ckt): Simulator(ckt) {
-        eventwheel = new EventWheel(ckt->getNumLevels());
+    EventWheel * eventwheel;
+    FaultGroup * group;
+    std::vector<Gate *> injected;
+    std::vector<Fault *> detections;
+    //fault groups still to simulate this cycle, first_group .. last_group - 1. The owner takes
+    //from the front, an idle worker steals the back half.
+    std::mutex lock;
+    unsigned int first_group;
+    unsigned int last_group;
+
+    FaultWorker(Circuit * ckt, unsigned int group_width) : first_group(0), last_group(0) {
+        eventwheel = new EventWheel(ckt->getLevelSizes(), ckt->getNumGates());
+        group = new FaultGroup(group_width, ckt->getNumGates());
     }
-    ~FaultSimulator() {
+    ~FaultWorker() {
         delete eventwheel;
+        delete group;
     }
+};
+
+//The good machine runs on the thread calling simCycle and is only read while the fault groups are
+//simulated. Groups of active faults are dealt out to num_threads workers, worker 0 being the calling
+//thread, and idle workers steal groups from busy ones.
+class FaultSimulator : public Simulator{
+    EventWheel * eventwheel; //good machine
+    std::vector<FaultWorker *> workers;
+    std::vector<std::thread> threads; //run workers 1 ..
+    bool initialized;
+
+    //simCycle bumps pool_cycle to start the threads on a cycle, the last one done signals pool_done
+    std::mutex pool_lock;
+    std::condition_variable pool_start;
+    std::condition_variable pool_done;
+    unsigned int pool_cycle;
+    unsigned int pool_running;
+    bool pool_exit;
+
+    //good machine only evaluates PIs that changed and flip flops whose D net changed since they last latched
+    std::vector<Gate *> changed_inputs;
+    std::vector<unsigned int> state_pos; //state var position of each flip flop, by gate id
+    StateVarSet pending_state;
+
+    void latchState();
+    inline void propagate(Gate * gate) {
+        for(unsigned int i = 0; i < gate->getNumFanout(); i++) {
+            Gate * fout = gate->getFanout(i);
+            if(fout->type() == Gate::D_FF) {
+                pending_state.insert(state_pos[fout->getId()]);
+            } else {
+                schedule(fout);
+            }
+        }
+    }
+    void runThread(unsigned int id);
+    bool claimGroup(unsigned int id, unsigned int & group_idx);
+    void simFaultGroups(unsigned int id);
+    void simFaultyEvents(FaultWorker & worker);
+    void mergeDetections();
+public:
+    //group_width faults are simulated per faulty machine pass, a multiple of 64
+    FaultSimulator(Circuit * ckt, unsigned int group_width = FAULT_GROUP_WIDTH_DEFAULT, unsigned int num_threads = 1);
+    ~FaultSimulator();
     void simCycle(const std::vector<char>&);
+    inline void schedule(Gate * gate) {
+        eventwheel->insertEvent(gate->getId() - 1, gate->getLevel());
+    }
     void simGoodEvents();
-    void simFaultyEvents();
 };
 
 class SimulatorFactory {
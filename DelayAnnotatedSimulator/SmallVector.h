@@ -0,0 +1,164 @@
+/*
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Kelson Gent
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#ifndef DelayAnnotatedSimulator_SmallVector_h
+#define DelayAnnotatedSimulator_SmallVector_h
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include "Arena.h"
+
+//Vector of trivially copyable elements that keeps up to N of them inside the object itself.
+//Longer lists move to the heap, or to an Arena when one is passed to reserve. Used for gate
+//adjacency, where nearly every gate has a handful of connections and the list never shrinks.
+//Counts are 32 bit and no allocator is stored, so the object is N elements plus 8 bytes.
+template <class T, unsigned int N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector holds plain data only");
+private:
+    static const uint32_t FROM_ARENA = 0x80000000; //capacity flag, storage is not freed
+
+    union {
+        T inline_data[N];
+        T * heap_data;
+    };
+    uint32_t count;
+    uint32_t capacity;
+
+    inline uint32_t getCapacity() const {
+        return capacity & ~FROM_ARENA;
+    }
+    inline bool isInline() const {
+        return capacity <= N;
+    }
+    void release() {
+        if(!isInline() && !(capacity & FROM_ARENA)) {
+            ::operator delete(heap_data);
+        }
+        capacity = N;
+    }
+    void copyFrom(const T * first, size_t num) {
+        reserve(num);
+        if(num) {
+            memcpy(data(), first, num * sizeof(T));
+        }
+        count = uint32_t(num);
+    }
+
+public:
+    typedef T value_type;
+    typedef T * iterator;
+    typedef const T * const_iterator;
+
+    SmallVector() : count(0), capacity(N) {}
+    template <class It>
+    SmallVector(It first, It last) : count(0), capacity(N) {
+        assign(first, last);
+    }
+    SmallVector(const SmallVector& other) : count(0), capacity(N) {
+        copyFrom(other.data(), other.size());
+    }
+    ~SmallVector() {
+        release();
+    }
+
+    SmallVector& operator= (const SmallVector& other) {
+        if(this != &other) {
+            count = 0;
+            copyFrom(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    inline T * data() {
+        return isInline() ? inline_data : heap_data;
+    }
+    inline const T * data() const {
+        return isInline() ? inline_data : heap_data;
+    }
+    inline size_t size() const {
+        return count;
+    }
+    inline bool empty() const {
+        return count == 0;
+    }
+    inline T& operator[] (size_t idx) {
+        return data()[idx];
+    }
+    inline const T& operator[] (size_t idx) const {
+        return data()[idx];
+    }
+    inline iterator begin() {
+        return data();
+    }
+    inline iterator end() {
+        return data() + count;
+    }
+    inline const_iterator begin() const {
+        return data();
+    }
+    inline const_iterator end() const {
+        return data() + count;
+    }
+
+    //grows the storage to at least num elements, from arena if given
+    void reserve(size_t num, Arena * arena = NULL) {
+        if(num <= getCapacity()) {
+            return;
+        }
+        T * grown = static_cast<T *>(arena ? arena->allocate(num * sizeof(T), alignof(T)) : ::operator new(num * sizeof(T)));
+        if(count) {
+            memcpy(grown, data(), count * sizeof(T));
+        }
+        release();
+        heap_data = grown;
+        capacity = uint32_t(num) | (arena ? FROM_ARENA : 0);
+    }
+    inline void push_back(const T& val) {
+        if(count == getCapacity()) {
+            reserve(2 * getCapacity());
+        }
+        data()[count++] = val;
+    }
+    template <class It>
+    void assign(It first, It last) {
+        count = 0;
+        reserve(std::distance(first, last));
+        for(; first != last; ++first) {
+            data()[count++] = *first;
+        }
+    }
+    inline void erase(iterator pos) {
+        memmove(pos, pos + 1, (end() - pos - 1) * sizeof(T));
+        count--;
+    }
+    inline void clear() {
+        count = 0;
+    }
+};
+
+#endif
@@ -25,10 +25,9 @@
 #ifndef DelayAnnotatedSimulator_Type_h
 #define DelayAnnotatedSimulator_Type_h
 
-#define NUM_FAULT_INJECT 16
-
 #include <algorithm>
 #include <iostream>
+#include <cstdint>
 
 class LogicValue {
 public:
@@ -113,6 +112,63 @@ inline LogicValue& LogicValue::operator^= (LogicValue rhs) {
     return *this;
 }
 
+//64 LogicValues packed dual-rail: bit i of lo/hi is bit 0/1 of the VALUES code of pattern i.
+//The operators work on both rails at once and match the LogicValue operators pattern by pattern.
+class PackedLogicValue {
+public:
+    static const unsigned int NUM_PATTERNS = 64;
+
+    uint64_t lo;
+    uint64_t hi;
+
+    PackedLogicValue() : lo(~0ULL), hi(0) {} //all X
+    PackedLogicValue(uint64_t lo, uint64_t hi) : lo(lo), hi(hi) {}
+    PackedLogicValue(LogicValue val) : lo((val.val & 0x01) ? ~0ULL : 0), hi((val.val & 0x02) ? ~0ULL : 0) {}
+
+    inline LogicValue get(unsigned int pattern) const {
+        return LogicValue(LogicValue::VALUES((((hi >> pattern) & 0x01) << 1) | ((lo >> pattern) & 0x01)));
+    }
+    inline void set(unsigned int pattern, LogicValue val) {
+        uint64_t mask = 0x01ULL << pattern;
+        lo = (val.val & 0x01) ? (lo | mask) : (lo & ~mask);
+        hi = (val.val & 0x02) ? (hi | mask) : (hi & ~mask);
+    }
+    //one bit per pattern holding that value
+    inline uint64_t isX() const {
+        return lo & ~hi;
+    }
+    inline uint64_t isZero() const {
+        return ~lo & ~hi;
+    }
+    inline uint64_t isOne() const {
+        return lo & hi;
+    }
+    inline bool operator== (const PackedLogicValue& rhs) const {
+        return (lo == rhs.lo) && (hi == rhs.hi);
+    }
+    inline bool operator!= (const PackedLogicValue& rhs) const {
+        return (lo != rhs.lo) || (hi != rhs.hi);
+    }
+};
+
+inline PackedLogicValue operator& (PackedLogicValue lhs, PackedLogicValue rhs) {
+    return PackedLogicValue(lhs.lo & rhs.lo, lhs.hi & rhs.hi);
+}
+
+inline PackedLogicValue operator| (PackedLogicValue lhs, PackedLogicValue rhs) {
+    return PackedLogicValue(lhs.lo | rhs.lo, lhs.hi | rhs.hi);
+}
+
+inline PackedLogicValue operator^ (PackedLogicValue lhs, PackedLogicValue rhs) {
+    uint64_t x = lhs.isX() | rhs.isX();
+    return PackedLogicValue((lhs.lo ^ rhs.lo) | x, (lhs.hi ^ rhs.hi) & ~x);
+}
+
+inline PackedLogicValue operator~ (PackedLogicValue lhs) {
+    uint64_t x = lhs.isX();
+    return PackedLogicValue(~lhs.lo | x, ~lhs.hi & ~x);
+}
+
 inline unsigned int pow2uint(unsigned int pow){
     if(pow >= 32) return 0;
     unsigned int operand = 0x01;
@@ -4,6 +4,16 @@
 #include "Gates.h"
 #include "Type.h"
 #include "Circuit.h"
+#include "FlatNetlist.h"
+#include "GateKernels.h"
+#include "PackedKernels.h"
+#include "CompiledCircuit.h"
+#include "GateLUT.h"
+#include "Arena.h"
+#include "EventWheel.h"
+#include "Simulator.h"
+#include <sstream>
+#include <cstring>
 
 #define TEST_FAIL 0
 #define TEST_PASS 1
@@ -26,6 +36,8 @@ unsigned int TestAnd() {
 
     andGate->addFanin(inputA);
     andGate->addFanin(inputB);
+    GateTable table {inputA, inputB, andGate};
+    andGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ZERO, LogicValue::ZERO, LogicValue::ZERO,
                                          LogicValue::ZERO, LogicValue::ONE, LogicValue::X,
@@ -60,6 +72,8 @@ unsigned int TestNand() {
 
     nandGate->addFanin(inputA);
     nandGate->addFanin(inputB);
+    GateTable table {inputA, inputB, nandGate};
+    nandGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ONE, LogicValue::ONE, LogicValue::ONE,
                                          LogicValue::ONE, LogicValue::ZERO, LogicValue::X,
@@ -94,6 +108,8 @@ unsigned int TestOr() {
 
     orGate->addFanin(inputA);
     orGate->addFanin(inputB);
+    GateTable table {inputA, inputB, orGate};
+    orGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ZERO, LogicValue::ONE, LogicValue::X,
                                          LogicValue::ONE, LogicValue::ONE, LogicValue::ONE,
@@ -128,6 +144,8 @@ unsigned int TestNor() {
 
     norGate->addFanin(inputA);
     norGate->addFanin(inputB);
+    GateTable table {inputA, inputB, norGate};
+    norGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ONE, LogicValue::ZERO, LogicValue::X,
                                          LogicValue::ZERO, LogicValue::ZERO, LogicValue::ZERO,
@@ -162,6 +180,8 @@ unsigned int TestXor() {
 
     xorGate->addFanin(inputA);
     xorGate->addFanin(inputB);
+    GateTable table {inputA, inputB, xorGate};
+    xorGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ZERO, LogicValue::ONE, LogicValue::X,
                                          LogicValue::ONE, LogicValue::ZERO, LogicValue::X,
@@ -196,6 +216,8 @@ unsigned int TestXNor() {
 
     xnorGate->addFanin(inputA);
     xnorGate->addFanin(inputB);
+    GateTable table {inputA, inputB, xnorGate};
+    xnorGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ONE, LogicValue::ZERO, LogicValue::X,
                                          LogicValue::ZERO, LogicValue::ONE, LogicValue::X,
@@ -227,6 +249,8 @@ unsigned int TestBuf() {
     Gate * bufGate = new BufGate(2, 5);
     InputGate * inputA = new InputGate(1, 0);
     bufGate->addFanin(inputA);
+    GateTable table {inputA, bufGate};
+    bufGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ONE, LogicValue::ZERO, LogicValue::X};
 
@@ -249,6 +273,8 @@ unsigned int TestNot() {
     Gate * notGate = new NotGate(2, 5);
     InputGate * inputA = new InputGate(1, 0);
     notGate->addFanin(inputA);
+    GateTable table {inputA, notGate};
+    notGate->setGateTable(&table);
 
     std::vector<LogicValue> input_values {LogicValue::ZERO, LogicValue::ONE, LogicValue::X};
     std::vector<LogicValue> exp_results {LogicValue::ONE, LogicValue::ZERO, LogicValue::X};
@@ -290,6 +316,8 @@ unsigned int TestOutput() {
     Gate * bufGate = new OutputGate(2, 5);
     InputGate * inputA = new InputGate(1, 0);
     bufGate->addFanin(inputA);
+    GateTable table {inputA, bufGate};
+    bufGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ONE, LogicValue::ZERO, LogicValue::X};
 
@@ -312,6 +340,8 @@ unsigned int TestDFF() {
     Gate * bufGate = new DffGate(2, 5);
     InputGate * inputA = new InputGate(1, 0);
     bufGate->addFanin(inputA);
+    GateTable table {inputA, bufGate};
+    bufGate->setGateTable(&table);
 
     std::vector<LogicValue> exp_results {LogicValue::ONE, LogicValue::ZERO, LogicValue::X};
 
@@ -340,6 +370,699 @@ unsigned int TestCircuit() {
     return TEST_PASS;
 }
 
+unsigned int TestFlatNetlist() {
+    Circuit * test = new Circuit("b01rst", false, false);
+    FlatNetlist * netlist = test->getNetlist();
+    if(netlist->getNumGates() != test->getNumGates()) {
+        return TEST_FAIL;
+    }
+    for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+        Gate * gate = test->getGateById(netlist->getGateId(i));
+        if(netlist->getIndex(gate->getId()) != i) {
+            return TEST_FAIL;
+        }
+        //renumbered gates stay in level order
+        if(i > 0 && netlist->getLevel(i - 1) > netlist->getLevel(i)) {
+            return TEST_FAIL;
+        }
+        if(netlist->type(i) != gate->type() || netlist->getLevel(i) != gate->getLevel()) {
+            return TEST_FAIL;
+        }
+        if(netlist->getNumFanin(i) != gate->getNumFanin() || netlist->getNumFanout(i) != gate->getNumFanout()) {
+            return TEST_FAIL;
+        }
+        for(unsigned int j = 0; j < gate->getNumFanin(); j++) {
+            if(netlist->getGateId(netlist->getFanin(i, j)) != gate->getFanin(j)->getId()) {
+                std::cerr << "FANIN MISMATCH AT GATE " << gate->getId() << std::endl;
+                return TEST_FAIL;
+            }
+        }
+        if(netlist->getValue(i) != LogicValue::X) {
+            return TEST_FAIL;
+        }
+    }
+    delete test;
+    return TEST_PASS;
+}
+
+unsigned int TestPackedLogicValue() {
+    //pattern i holds the pair (i / 4, i % 4) so every combination is checked at once
+    PackedLogicValue lhs, rhs;
+    for(unsigned int i = 0; i < 16; i++) {
+        lhs.set(i, LogicValue(LogicValue::VALUES(i / 4)));
+        rhs.set(i, LogicValue(LogicValue::VALUES(i % 4)));
+    }
+    PackedLogicValue and_val = lhs & rhs;
+    PackedLogicValue or_val = lhs | rhs;
+    PackedLogicValue xor_val = lhs ^ rhs;
+    PackedLogicValue not_val = ~lhs;
+    for(unsigned int i = 0; i < 16; i++) {
+        LogicValue a = lhs.get(i);
+        LogicValue b = rhs.get(i);
+        if(and_val.get(i) != (a & b) || or_val.get(i) != (a | b) ||
+           xor_val.get(i) != (a ^ b) || not_val.get(i) != ~a) {
+            std::cerr << "PACKED MISMATCH: " << a.ascii() << " " << b.ascii() << std::endl;
+            return TEST_FAIL;
+        }
+    }
+    return TEST_PASS;
+}
+
+unsigned int TestPackedKernels() {
+    //gates 0-2 are inputs cycling through every value combination, gate 3 is the output.
+    //every vector kernel is checked against the LogicValue kernel of the same gate type.
+    const unsigned int types[] = { Gate::AND, Gate::NAND, Gate::OR, Gate::NOR, Gate::XOR, Gate::XNOR,
+                                   Gate::NOT, Gate::BUF, Gate::MUX_2, Gate::TRISTATE, Gate::TIE_ONE };
+    const unsigned int fin[] = { 0, 1, 2 };
+    for(unsigned int isa = PackedKernels::SCALAR; isa <= PackedKernels::AVX512; isa++) {
+        if(!PackedKernels::isSupported(PackedKernels::ISA(isa))) continue;
+        unsigned int words = PackedKernels::vectorWords(PackedKernels::ISA(isa));
+        std::vector<uint64_t> values(4 * 2 * words, 0);
+        for(unsigned int p = 0; p < words * 64; p++) {
+            for(unsigned int g = 0; g < 3; g++) {
+                unsigned int code = (p >> (2 * g)) & 0x03;
+                values[g * 2 * words + p / 64] |= (uint64_t) (code & 0x01) << (p % 64);
+                values[g * 2 * words + words + p / 64] |= (uint64_t) (code >> 1) << (p % 64);
+            }
+        }
+        for(unsigned int t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+            unsigned int num_fanin = (types[t] == Gate::MUX_2) ? 3 : 2;
+            PackedKernels::table(PackedKernels::ISA(isa))[types[t]](values.data(), 3, fin, num_fanin, words);
+            for(unsigned int p = 0; p < words * 64; p++) {
+                unsigned char scalar[3];
+                for(unsigned int g = 0; g < 3; g++) {
+                    scalar[g] = (p >> (2 * g)) & 0x03;
+                }
+                LogicValue expected = GateKernels::get(types[t], num_fanin)(scalar, fin, num_fanin);
+                uint64_t lo = values[3 * 2 * words + p / 64] >> (p % 64);
+                uint64_t hi = values[3 * 2 * words + words + p / 64] >> (p % 64);
+                if(expected.val != (((hi & 0x01) << 1) | (lo & 0x01))) {
+                    std::cerr << PackedKernels::name(PackedKernels::ISA(isa)) << " MISMATCH TYPE " << types[t] << std::endl;
+                    return TEST_FAIL;
+                }
+            }
+        }
+    }
+    return TEST_PASS;
+}
+
+unsigned int TestCompiledCircuitSource() {
+    //one assignment per gate that is not a primary input
+    Circuit * test = new Circuit("b01rst", false, false);
+    FlatNetlist * netlist = test->getNetlist();
+    std::stringstream source;
+    CompiledCircuit::generate(netlist, source);
+    unsigned int assignments = 0;
+    std::string line;
+    while(std::getline(source, line)) {
+        if(line.find("    v[") == 0) assignments++;
+    }
+    if(assignments != netlist->getNumGates() - netlist->getNumInput()) {
+        std::cerr << "ASSIGNMENTS: " << assignments << std::endl;
+        return TEST_FAIL;
+    }
+    delete test;
+    return TEST_PASS;
+}
+
+unsigned int TestFaninCounting() {
+    //counted evaluation has to match the kernels for any mix of values
+    Circuit * test = new Circuit("b01rst", false, false);
+    FlatNetlist * netlist = test->getNetlist();
+    srand(1);
+    for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+        netlist->setValue(i, LogicValue(LogicValue::VALUES(rand() % 4)));
+    }
+    netlist->setFaninCounting(true);
+    for(unsigned int round = 0; round < 4; round++) {
+        for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+            if(!GateKernels::isCounted(netlist->type(i))) continue;
+            LogicValue expected = netlist->getValue(netlist->getFanin(i, 0));
+            for(unsigned int j = 1; j < netlist->getNumFanin(i); j++) {
+                LogicValue fin = netlist->getValue(netlist->getFanin(i, j));
+                bool is_and = netlist->type(i) == Gate::AND || netlist->type(i) == Gate::NAND;
+                expected = is_and ? (expected & fin) : (expected | fin);
+            }
+            if(netlist->type(i) == Gate::NAND || netlist->type(i) == Gate::NOR) expected = ~expected;
+            netlist->evaluate(i, false);
+            if(netlist->getValue(i) != expected) {
+                std::cerr << "COUNTED MISMATCH AT GATE " << i + 1 << std::endl;
+                return TEST_FAIL;
+            }
+        }
+        for(unsigned int i = 0; i < netlist->getNumInput(); i++) {
+            netlist->setValue(netlist->getInput(i), LogicValue(LogicValue::VALUES(rand() % 4)));
+        }
+    }
+    delete test;
+    return TEST_PASS;
+}
+
+unsigned int TestGateLUT() {
+    //3 input NAND: every entry against the LogicValue operators and the setGIC slot
+    GateLUT lut(Gate::NAND, 3);
+    for(unsigned int idx = 0; idx < 64; idx++) {
+        LogicValue a = LogicValue::VALUES((idx >> 4) & 0x03);
+        LogicValue b = LogicValue::VALUES((idx >> 2) & 0x03);
+        LogicValue c = LogicValue::VALUES(idx & 0x03);
+        unsigned char entry = lut.data()[idx];
+        if((entry & GateLUT::OUTPUT_MASK) != (~(a & b & c)).val) {
+            return TEST_FAIL;
+        }
+        bool binary = (a == LogicValue::ZERO || a == LogicValue::ONE) &&
+                      (b == LogicValue::ZERO || b == LogicValue::ONE) &&
+                      (c == LogicValue::ZERO || c == LogicValue::ONE);
+        if(binary != ((entry & GateLUT::GIC_VALID) != 0)) {
+            return TEST_FAIL;
+        }
+        unsigned int slot = ((a == LogicValue::ONE) << 2) | ((b == LogicValue::ONE) << 1) | (c == LogicValue::ONE);
+        if(binary && (entry >> GateLUT::GIC_SHIFT) != slot) {
+            return TEST_FAIL;
+        }
+    }
+    return TEST_PASS;
+}
+
+unsigned int TestArena() {
+    Arena arena(256);
+    char * last = NULL;
+    for(unsigned int i = 1; i < 100; i++) {
+        char * ptr = static_cast<char *>(arena.allocate(i, 8));
+        if(reinterpret_cast<size_t>(ptr) % 8 != 0 || ptr == last) {
+            return TEST_FAIL;
+        }
+        memset(ptr, 0xFF, i);
+        last = ptr;
+    }
+    //oversized request
+    if(arena.allocate(4096, 16) == NULL) {
+        return TEST_FAIL;
+    }
+    GateList list;
+    list.reserve(20, &arena);
+    for(unsigned int i = 0; i < 50; i++) {
+        list.push_back(i + 1);
+    }
+    return (list.size() == 50) ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestSmallVector() {
+    GateList list;
+    for(unsigned int i = 0; i < 8; i++) {
+        list.push_back(i + 1);
+        GateList copy(list);
+        if(copy.size() != i + 1) {
+            return TEST_FAIL;
+        }
+        for(unsigned int j = 0; j <= i; j++) {
+            if(copy[j] != j + 1) {
+                return TEST_FAIL;
+            }
+        }
+    }
+    std::vector<unsigned int> fin(list.begin(), list.begin() + 2);
+    list.assign(fin.begin(), fin.end());
+    if(list.size() != 2 || list[1] != 2) {
+        return TEST_FAIL;
+    }
+
+    //adjacency resolves through the gate table
+    Gate gates[3] = {Gate(1), Gate(2), Gate(3)};
+    GateTable table {&gates[0], &gates[1], &gates[2]};
+    gates[2].setGateTable(&table);
+    gates[2].addFanin(&gates[1]);
+    gates[2].addFanin(&gates[0]);
+    if(gates[2].getFanin(0) != &gates[1] || gates[2].getFanin(1) != &gates[0] || gates[2].getFaninId(1) != 1) {
+        return TEST_FAIL;
+    }
+    return TEST_PASS;
+}
+
+unsigned int TestFaultGroup() {
+    //OUT = AND(a, b) with a sa0, AND output sa1 and AND input b sa1
+    std::fstream lev("group_test.lev", std::fstream::out);
+    lev << "5\n\n"
+        << "1 1 0 0 1 3 ; 0 0\n"
+        << "2 1 0 0 1 3 ; 0 0\n"
+        << "3 6 5 2 1 2 1 2 1 4 ; 0 0\n"
+        << "4 2 10 1 3 3 0 ; 0 0\n";
+    lev.close();
+    std::fstream eqf("group_test.eqf", std::fstream::out);
+    eqf << "1 0 0\n3 0 1\n3 2 1\n";
+    eqf.close();
+
+    //reads of invalid slots give the good value
+    FaultGroup group(128, 4);
+    Fault flt(3, 0, LogicValue::ONE, 0);
+    for(unsigned int i = 0; i < 70; i++) {
+        group.addFault(&flt);
+    }
+    group.injectState(2, 69, LogicValue::ZERO);
+    PackedLogicValue val = group.getFaulty(2, 1, LogicValue::ONE);
+    if(group.getWidth() != 128 || group.getNumTouched() != 2 || val.get(5) != LogicValue::ZERO || val.get(4) != LogicValue::ONE ||
+       group.getFaulty(3, 0, LogicValue::ZERO).get(0) != LogicValue::X || group.firstSite(3) != 69) {
+        return TEST_FAIL;
+    }
+    group.clear();
+    if(group.size() != 0 || group.getValid(2, 1) != 0 || group.getValid(3, 1) != 0 || group.getNumTouched() != 0 ||
+       group.firstSite(3) != FaultGroup::NO_SLOT) {
+        return TEST_FAIL;
+    }
+
+    Circuit * test = new Circuit("group_test", false, true);
+    FaultSimulator * sim = new FaultSimulator(test, 256);
+    std::vector<char> vec(2, '1');
+    sim->simCycle(vec); //detects a sa0
+    bool pass = (test->calculateFaultCov() == 1.0 / 3.0);
+    vec[1] = '0';
+    sim->simCycle(vec); //detects both sa1
+    pass &= (test->calculateFaultCov() == 1.0);
+    delete sim;
+    delete test;
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestFaultThreads() {
+    //chain of 40 gates, gate g fed by g - 1 and g - 3, with both stuck at faults on every gate output
+    std::fstream lev("thread_test.lev", std::fstream::out);
+    std::fstream eqf("thread_test.eqf", std::fstream::out);
+    const unsigned int types[3] = {6, 3, 8}; //AND, XOR, OR
+    lev << "45\n\n";
+    for(unsigned int g = 1; g <= 44; g++) {
+        std::vector<unsigned int> fout;
+        for(unsigned int x = 4; x <= 43; x++) {
+            if(x - 1 == g || x - 3 == g) {
+                fout.push_back(x);
+            }
+        }
+        if(g == 43) {
+            fout.push_back(44);
+        }
+        if(g <= 3) {
+            lev << g << " 1 0 0 ";
+        } else if(g == 44) {
+            lev << g << " 2 " << 5 * 41 << " 1 43 43 ";
+        } else {
+            lev << g << " " << types[g % 3] << " " << 5 * (g - 3) << " 2 " << g - 1 << " " << g - 3 << " " << g - 1 << " " << g - 3 << " ";
+            eqf << g << " 0 0\n" << g << " 0 1\n";
+        }
+        lev << fout.size();
+        for(unsigned int i = 0; i < fout.size(); i++) {
+            lev << " " << fout[i];
+        }
+        lev << " ; 0 0\n";
+    }
+    lev.close();
+    eqf.close();
+
+    Circuit * serial = new Circuit("thread_test", false, true);
+    Circuit * threaded = new Circuit("thread_test", false, true);
+    FaultSimulator * serial_sim = new FaultSimulator(serial, 64, 1);
+    FaultSimulator * threaded_sim = new FaultSimulator(threaded, 64, 3);
+    bool pass = true;
+    unsigned int seed = 1;
+    for(unsigned int cycle = 0; cycle < 16; cycle++) {
+        std::vector<char> vec(3);
+        for(unsigned int i = 0; i < vec.size(); i++) {
+            seed = seed * 1103515245 + 12345;
+            vec[i] = ((seed >> 16) & 1) ? '1' : '0';
+        }
+        serial_sim->simCycle(vec);
+        threaded_sim->simCycle(vec);
+        pass &= (serial->calculateFaultCov() == threaded->calculateFaultCov());
+    }
+    pass &= (serial->calculateFaultCov() > 0.5);
+    delete serial_sim;
+    delete threaded_sim;
+    delete serial;
+    delete threaded;
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestPPSFP() {
+    //OUT = DFF(AND(a, b)) with AND output sa0 and sa1 and DFF output sa1
+    std::fstream lev("ppsfp_test.lev", std::fstream::out);
+    lev << "6\n\n"
+        << "1 1 0 0 1 3 ; 0 0\n"
+        << "2 1 0 0 1 3 ; 0 0\n"
+        << "3 6 5 2 1 2 1 2 1 4 ; 0 0\n"
+        << "4 5 0 1 3 3 1 5 ; 0 0\n"
+        << "5 2 5 1 4 4 0 ; 0 0\n";
+    lev.close();
+    std::fstream eqf("ppsfp_test.eqf", std::fstream::out);
+    eqf << "3 0 0\n3 0 1\n4 0 1\n";
+    eqf.close();
+
+    Circuit * test = new Circuit("ppsfp_test", false, true);
+    PPSFPSimulator * sim = new PPSFPSimulator(test);
+    //sa0 is observed at the D net in the same pattern, the flip flop output is still X
+    sim->simCycle(std::vector<char>(2, '1'));
+    bool pass = (test->calculateFaultCov() == 1.0 / 3.0);
+    //sa1 at the D net, then the flip flop output sa1 at the PO once the scanned in state is 0
+    sim->simBatch(std::vector<std::vector<char> >(2, std::vector<char>(2, '0')));
+    pass &= (test->calculateFaultCov() == 1.0);
+    delete sim;
+    delete test;
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestFaultCollapse() {
+    //OUT = NOT(AND(a, b)): a sa0 through OUT sa1 form one class, AND sa1 dominates its input b sa1
+    std::fstream lev("collapse_test.lev", std::fstream::out);
+    lev << "6\n\n"
+        << "1 1 0 0 1 3 ; 0 0\n"
+        << "2 1 0 0 1 3 ; 0 0\n"
+        << "3 6 5 2 1 2 1 2 1 4 ; 0 0\n"
+        << "4 10 10 1 3 3 1 5 ; 0 0\n"
+        << "5 2 15 1 4 4 0 ; 0 0\n";
+    lev.close();
+    std::fstream eqf("collapse_test.eqf", std::fstream::out);
+    eqf << "1 0 0\n3 1 0\n3 0 0\n4 1 0\n4 0 1\n3 0 1\n3 2 1\n5 0 1\n";
+    eqf.close();
+
+    Circuit * test = new Circuit("collapse_test", false, true);
+    const bool collapsed[8] = {false, true, true, true, true, false, false, true};
+    bool pass = true;
+    for(unsigned int i = 0; i < test->numFaults(); i++) {
+        pass &= (test->getFault(i)->isCollapsed() == collapsed[i]);
+    }
+    //coverage counts the collapsed faults with their representative
+    PPSFPSimulator * sim = new PPSFPSimulator(test);
+    std::vector<char> vec(2, '1');
+    vec[1] = '0';
+    sim->simCycle(vec);
+    pass &= (test->calculateFaultCov() == 2.0 / 8.0);
+    vec[1] = '1';
+    sim->simCycle(vec);
+    pass &= (test->calculateFaultCov() == 1.0);
+    delete sim;
+    delete test;
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestSimplify() {
+    //OUT = NOT(AND(BUF(a), TIE1)) collapses to OUT = NAND(a)
+    std::fstream lev("simplify_test.lev", std::fstream::out);
+    lev << "8\n\n"
+        << "1 1 0 0 1 4 ; 0 0\n"
+        << "2 1 0 0 0 ; 0 0\n"
+        << "3 12 0 0 1 5 ; 0 0\n"
+        << "4 11 5 1 1 1 1 5 ; 0 0\n"
+        << "5 6 10 2 4 3 4 3 1 6 ; 0 0\n"
+        << "6 10 15 1 5 5 1 7 ; 0 0\n"
+        << "7 2 20 1 6 6 0 ; 0 0\n";
+    lev.close();
+    std::fstream cap("simplify_test.cap", std::fstream::out);
+    cap << "1 1.5\n5 9.0\n6 4.0\n7 2.5\n";
+    cap.close();
+    Circuit * test = new Circuit("simplify_test", false, false);
+    test->readCapacitance("simplify_test.cap");
+    test->simplify();
+    Gate * driver = test->getOutput(0)->getFanin(0);
+    bool pass = (test->getNumGates() == 4) && (driver->type() == Gate::NAND) &&
+                (driver->getNumFanin() == 1) && (driver->getFanin(0) == test->getInputs()[0]);
+    for(unsigned int i = 1; i <= test->getNumGates(); i++) {
+        pass &= (test->getGateById(i)->getId() == i);
+    }
+    //capacitances follow the kept gates 1, 2, 5 (now the NAND) and 7, the NOT's is dropped
+    pass &= (test->getCapacitance(1) == 1.5) && (test->getCapacitance(2) == 0.0) &&
+            (test->getCapacitance(3) == 9.0) && (test->getCapacitance(4) == 2.5);
+    delete test;
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestLogicEngines() {
+    //100 cycles of random inputs then 100 of held inputs through the event wheel, the sweep and AUTO.
+    //Every engine must give the same POs, state, GIC and toggle coverage each cycle, and AUTO has to
+    //enter the sweep during the busy cycles and leave it once the inputs are held.
+    LogicSimulator::Engine engines[3] = {LogicSimulator::EVENT_DRIVEN, LogicSimulator::OBLIVIOUS, LogicSimulator::AUTO};
+    Circuit * circuits[3];
+    LogicSimulator * sims[3];
+    for(unsigned int e = 0; e < 3; e++) {
+        circuits[e] = new Circuit("b01rst", false, false);
+        sims[e] = new LogicSimulator(circuits[e], engines[e]);
+    }
+    bool pass = true;
+    bool entered = false;
+    bool left = false;
+    unsigned int seed = 1;
+    for(unsigned int cycle = 0; cycle < 200 && pass; cycle++) {
+        std::vector<char> vec(circuits[0]->getNumInput(), '1');
+        for(unsigned int i = 0; i < vec.size(); i++) {
+            if(cycle < 100) {
+                seed = seed * 1103515245 + 12345;
+                vec[i] = ((seed >> 16) & 0x01) ? '1' : '0';
+            } else if(i + 1 == vec.size()) {
+                vec[i] = '0';
+            }
+        }
+        std::string dumps[3];
+        for(unsigned int e = 0; e < 3; e++) {
+            sims[e]->simCycle(vec);
+            std::stringstream ss;
+            sims[e]->dumpPO(ss);
+            sims[e]->dumpState(ss);
+            FlatNetlist * netlist = circuits[e]->getNetlist();
+            ss << netlist->calculateGIC() << " " << netlist->calculateToggle();
+            dumps[e] = ss.str();
+        }
+        pass &= (dumps[0] == dumps[1]) && (dumps[0] == dumps[2]);
+        pass &= !sims[0]->isSweeping() && sims[1]->isSweeping();
+        if(cycle < 100) {
+            entered |= sims[2]->isSweeping();
+        } else if(entered) {
+            left |= !sims[2]->isSweeping();
+        }
+    }
+    for(unsigned int e = 0; e < 3; e++) {
+        delete sims[e];
+        delete circuits[e];
+    }
+    return (pass && entered && left) ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestFanoutFreeRegions() {
+    Circuit * test = new Circuit("b01rst", false, false);
+    FlatNetlist * netlist = test->getNetlist();
+    unsigned int members = 0;
+    for(unsigned int i = 0; i < netlist->getNumGates(); i++) {
+        unsigned int root = netlist->getRegionRoot(i);
+        if(root != i) {
+            //internal gates feed exactly one gate of the same region
+            if(netlist->getNumFanout(i) != 1 || netlist->getRegionRoot(*netlist->fanoutBegin(i)) != root) {
+                return TEST_FAIL;
+            }
+            continue;
+        }
+        const unsigned int * first = netlist->regionBegin(i);
+        const unsigned int * last = netlist->regionEnd(i);
+        if(first == last || *(last - 1) != i) {
+            return TEST_FAIL;
+        }
+        for(const unsigned int * member = first; member != last; ++member) {
+            if(netlist->getRegionRoot(*member) != i || (member != first && netlist->getLevel(*(member - 1)) > netlist->getLevel(*member))) {
+                return TEST_FAIL;
+            }
+        }
+        members += last - first;
+    }
+    bool pass = (members == netlist->getNumGates());
+    delete test;
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestEventWheel() {
+    std::vector<unsigned int> level_sizes(70, 2);
+    EventWheel wheel(level_sizes, 8);
+    wheel.insertEvent(5, 67);
+    wheel.insertEvent(3, 2);
+    wheel.insertEvent(4, 2);
+    wheel.insertEvent(3, 2); //already scheduled, dropped
+    wheel.insertEvent(1, 0);
+    unsigned int expected[] = {1, 3, 4, 5};
+    for(unsigned int i = 0; i < 4; i++) {
+        if(wheel.getNextScheduled() != expected[i]) {
+            return TEST_FAIL;
+        }
+    }
+    if(wheel.getNextScheduled() != EventWheel::NO_EVENT) {
+        return TEST_FAIL;
+    }
+    //next round starts over from level 0 and reuses the ring slots
+    wheel.insertEvent(3, 2);
+    wheel.insertEvent(6, 1);
+    wheel.insertEvent(7, 2);
+    if(wheel.getNextScheduled() != 6 || wheel.getNextScheduled() != 3 || wheel.getNextScheduled() != 7) {
+        return TEST_FAIL;
+    }
+    return (wheel.getNextScheduled() == EventWheel::NO_EVENT) ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestGateDelayWheel() {
+    GateDelayWheel wheel;
+    wheel.insertEvent(1, 5000000000000ULL); //5 seconds in ps
+    wheel.insertEvent(2, 70);
+    wheel.insertEvent(3, 3);
+    wheel.insertEvent(4, 70);
+    wheel.insertEvent(5, 4096);
+    unsigned int expected[] = {3, 2, 4, 5, 1};
+    uint64_t times[] = {3, 70, 70, 4096, 5000000000000ULL};
+    for(unsigned int i = 0; i < 5; i++) {
+        if(wheel.getNextScheduled() != expected[i] || wheel.getCurrentTime() != times[i]) {
+            return TEST_FAIL;
+        }
+        if(i == 1) {
+            wheel.insertEvent(6, 0); //same time, after the already queued event 4
+        }
+        if(i == 2 && wheel.getNextScheduled() != 6) {
+            return TEST_FAIL;
+        }
+    }
+    if(wheel.getNextScheduled() != GateDelayWheel::NO_EVENT || wheel.size() != 0) {
+        return TEST_FAIL;
+    }
+    //time carries on from the last event
+    wheel.insertEvent(7, 1);
+    return (wheel.getNextScheduled() == 7 && wheel.getCurrentTime() == 5000000000001ULL) ? TEST_PASS : TEST_FAIL;
+}
+
+//writes <name>.lev for OUT = AND(a, NOT(a)): a rising a gives a pulse on the AND as wide as the
+//NOT delay. Gate ids: a 1, NOT 2, AND 3, OUT 4.
+static void writeGlitchNetlist(const std::string& name) {
+    std::fstream lev((name + ".lev").c_str(), std::fstream::out);
+    lev << "5\n\n"
+        << "1 1 0 0 2 2 3 ; 0 0\n"
+        << "2 10 5 1 1 1 1 3 ; 0 0\n"
+        << "3 6 10 2 1 2 1 2 1 4 ; 0 0\n"
+        << "4 2 15 1 3 3 0 ; 0 0\n";
+    lev.close();
+}
+
+unsigned int TestInertialDelay() {
+    writeGlitchNetlist("glitch_test");
+    double toggle[2];
+    LogicValue out[2];
+    for(unsigned int model = 0; model < 2; model++) {
+        Circuit * test = new Circuit("glitch_test", true, false);
+        LogicDelaySimulator * sim = new LogicDelaySimulator(test, LogicDelaySimulator::DelayModel(model));
+        sim->simCycle(std::vector<char>(1, '0'));
+        sim->simCycle(std::vector<char>(1, '1'));
+        toggle[model] = test->getNetlist()->calculateToggle();
+        out[model] = sim->getOutputs()[0];
+        delete sim;
+        delete test;
+    }
+    //transport: NOT falls, AND and OUT pulse. inertial: only the NOT falls
+    bool pass = (toggle[LogicDelaySimulator::TRANSPORT] == 5.0 / 6.0) && (toggle[LogicDelaySimulator::INERTIAL] == 1.0 / 6.0);
+    pass &= (out[0] == LogicValue::ZERO) && (out[1] == LogicValue::ZERO);
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestInertialPendingKept() {
+    //OUT = AND(OR(BUF(a), BUF(b)), NOT(a)). a rising gives a 10 wide pulse on the AND from the OR
+    //rising at 40 and the NOT falling at 50. b rising with it reaches the OR at 20 without changing
+    //the value it is heading to, so the OR must still rise at 40.
+    std::fstream lev("inertial_hold_test.lev", std::fstream::out);
+    lev << "9\n\n"
+        << "1 1 0 0 2 3 6 ; 0 0\n"
+        << "2 1 0 0 1 4 ; 0 0\n"
+        << "3 11 5 1 1 1 1 5 ; 0 0\n"
+        << "4 11 5 1 2 2 1 5 ; 0 0\n"
+        << "5 8 10 2 3 4 3 4 1 7 ; 0 0\n"
+        << "6 10 5 1 1 1 1 7 ; 0 0\n"
+        << "7 6 15 2 5 6 5 6 1 8 ; 0 0\n"
+        << "8 2 20 1 7 7 0 ; 0 0\n";
+    lev.close();
+    std::fstream idly("inertial_hold_test.idly", std::fstream::out);
+    idly << "3 10\n4 20\n5 30\n6 50\n7 5\n";
+    idly.close();
+    const char * second[2] = {"10", "11"};
+    bool pass = true;
+    for(unsigned int i = 0; i < 2; i++) {
+        Circuit * test = new Circuit("inertial_hold_test", true, false);
+        LogicDelaySimulator * sim = new LogicDelaySimulator(test, LogicDelaySimulator::INERTIAL);
+        sim->simCycle(std::vector<char>(2, '0'));
+        sim->simCycle(std::vector<char>(second[i], second[i] + 2));
+        //the OR leaves X in the first cycle and rises once in the second, the AND pulses
+        pass &= (sim->getTransitions(5) == 2) && (sim->getGlitches(7) == 2);
+        delete sim;
+        delete test;
+    }
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestRiseFallDelay() {
+    //per instance delays on the AND of the glitch netlist
+    writeGlitchNetlist("risefall_test");
+    //slow rise: the AND output falls before it would rise, transport drops the pulse.
+    //slow fall: the pulse is wider than the NOT delay
+    const char * and_delays[2] = {"3 3 1\n", "3 1 3 # rise fall\n"};
+    double toggle[2];
+    LogicValue out[2];
+    for(unsigned int i = 0; i < 2; i++) {
+        std::fstream idly("risefall_test.idly", std::fstream::out);
+        idly << and_delays[i];
+        idly.close();
+        Circuit * test = new Circuit("risefall_test", true, false);
+        LogicDelaySimulator * sim = new LogicDelaySimulator(test, LogicDelaySimulator::TRANSPORT);
+        sim->simCycle(std::vector<char>(1, '0'));
+        sim->simCycle(std::vector<char>(1, '1'));
+        toggle[i] = test->getNetlist()->calculateToggle();
+        out[i] = sim->getOutputs()[0];
+        delete sim;
+        delete test;
+    }
+    bool pass = (toggle[0] == 1.0 / 6.0) && (toggle[1] == 5.0 / 6.0);
+    pass &= (out[0] == LogicValue::ZERO) && (out[1] == LogicValue::ZERO);
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestSwitchingActivity() {
+    //the rising a gives a pulse on the AND and OUT of the glitch netlist
+    writeGlitchNetlist("activity_test");
+    std::fstream cap("activity_test.cap", std::fstream::out);
+    cap << "# gate cap\n3 2.0\n4 0.5\n";
+    cap.close();
+    Circuit * test = new Circuit("activity_test", true, false);
+    test->readCapacitance("activity_test.cap");
+    LogicDelaySimulator * sim = new LogicDelaySimulator(test, LogicDelaySimulator::TRANSPORT);
+    sim->simCycle(std::vector<char>(1, '0'));
+    sim->simCycle(std::vector<char>(1, '1'));
+    //first cycle every gate leaves X, second the AND and OUT switch twice
+    bool pass = (sim->getTransitions(3) == 3) && (sim->getGlitches(3) == 2) && (sim->getGlitches(2) == 0);
+    pass &= (sim->getCycleTransitions().size() == 2) && (sim->getCycleTransitions()[0] == 4) && (sim->getCycleTransitions()[1] == 6);
+    pass &= (sim->getCycleSwitchedCap()[0] == 2.5) && (sim->getCycleSwitchedCap()[1] == 5.0);
+    pass &= (sim->estimatePower(1.0, 2.0) == 3.75);
+    delete sim;
+    delete test;
+    return pass ? TEST_PASS : TEST_FAIL;
+}
+
+unsigned int TestStateVarSet() {
+    StateVarSet pending;
+    pending.assign(130, false);
+    pending.insert(129);
+    pending.insert(3);
+    if(pending.next(0) != 3 || pending.next(4) != 129) {
+        return TEST_FAIL;
+    }
+    //positions added ahead of the walk are visited in the same pass
+    unsigned int visited = 0;
+    for(unsigned int pos = pending.next(0); pos != StateVarSet::END; pos = pending.next(pos + 1)) {
+        pending.erase(pos);
+        if(pos == 3) {
+            pending.insert(70);
+            pending.insert(1);
+        }
+        visited++;
+    }
+    if(visited != 3 || pending.next(0) != 1 || pending.next(2) != StateVarSet::END) {
+        return TEST_FAIL;
+    }
+    pending.assign(130, true);
+    return (pending.next(129) == 129 && pending.next(130) == StateVarSet::END) ? TEST_PASS : TEST_FAIL;
+}
+
 /*int main(){
   std::cerr << TestAnd() << std::endl;
   std::cerr << TestNand() << std::endl;
@@ -353,5 +1076,27 @@ unsigned int TestCircuit() {
   std::cerr << TestInput() << std::endl;
   std::cerr << TestOutput() << std::endl;
   std::cerr << TestCircuit() << std::endl;
+  std::cerr << TestFlatNetlist() << std::endl;
+  std::cerr << TestPackedLogicValue() << std::endl;
+  std::cerr << TestPackedKernels() << std::endl;
+  std::cerr << TestCompiledCircuitSource() << std::endl;
+  std::cerr << TestFaninCounting() << std::endl;
+  std::cerr << TestGateLUT() << std::endl;
+  std::cerr << TestArena() << std::endl;
+  std::cerr << TestSmallVector() << std::endl;
+  std::cerr << TestSimplify() << std::endl;
+  std::cerr << TestLogicEngines() << std::endl;
+  std::cerr << TestFanoutFreeRegions() << std::endl;
+  std::cerr << TestFaultGroup() << std::endl;
+  std::cerr << TestFaultThreads() << std::endl;
+  std::cerr << TestPPSFP() << std::endl;
+  std::cerr << TestFaultCollapse() << std::endl;
+  std::cerr << TestEventWheel() << std::endl;
+  std::cerr << TestStateVarSet() << std::endl;
+  std::cerr << TestGateDelayWheel() << std::endl;
+  std::cerr << TestInertialDelay() << std::endl;
+  std::cerr << TestInertialPendingKept() << std::endl;
+  std::cerr << TestRiseFallDelay() << std::endl;
+  std::cerr << TestSwitchingActivity() << std::endl;
     getchar();
 }*/
@@ -36,9 +36,60 @@ int main(int argc, const char * argv[]) {
     // insert code here...
     Args args;
     args.readArgs(argc, argv);
-    Circuit * circuit = new Circuit(args.getCircuitName(), false, false, args.getGroupingSize());
-    LogicSimulator * simulator = new LogicSimulator(circuit);
+    bool fault_sim = (args.getSimulatorType() == 1) || args.isPPSFP();
+    Circuit * circuit = new Circuit(args.getCircuitName(), args.isDelay(), fault_sim, args.getGroupingSize());
+    if(args.isCapacitance()) {
+        circuit->readCapacitance(args.getCircuitName() + ".cap");
+    }
+    if(args.isSimplify()) {
+        circuit->simplify();
+    }
     InputVector test_vector(args.getInputSource());
+    if(args.isParallelPattern() || args.isPPSFP()) {
+        ParallelLogicSimulator * simulator;
+        if(args.isPPSFP()) {
+            simulator = new PPSFPSimulator(circuit);
+        } else {
+            simulator = new ParallelLogicSimulator(circuit);
+        }
+        while(!test_vector.isDone()) {
+            std::vector<std::vector<char> > batch;
+            while(batch.size() < simulator->getBatchCapacity()) {
+                std::vector<char> vec = test_vector.getNext();
+                if(test_vector.isDone())
+                    break;
+                batch.push_back(vec);
+            }
+            if(batch.empty())
+                break;
+
+            simulator->simBatch(batch);
+            for(unsigned int i = 0; i < batch.size(); i++) {
+                if (args.isOutputState()) {
+                    simulator->dumpState(args.getOutputSource(), i);
+                }
+                if(args.isOutputPO()) {
+                    simulator->dumpPO(args.getOutputSource(), i);
+                }
+            }
+        }
+        delete circuit;
+        delete simulator;
+        return 0;
+    }
+
+    Simulator * simulator;
+    LogicDelaySimulator * delay_simulator = NULL;
+    if(fault_sim) {
+        simulator = new FaultSimulator(circuit, args.getFaultGroupWidth(), args.getFaultThreads());
+    } else if(args.isDelay()) {
+        delay_simulator = new LogicDelaySimulator(circuit, LogicDelaySimulator::DelayModel(args.getDelayModel()));
+        simulator = delay_simulator;
+    } else if(args.isCompiled()) {
+        simulator = new CompiledSimulator(circuit, args.getCircuitName());
+    } else {
+        simulator = new LogicSimulator(circuit, LogicSimulator::Engine(args.getLogicEngine()));
+    }
     //std::fstream fault_out(args.getCircuitName() + "_fault.csv", std::fstream::out);
     unsigned int vec_num = 0;
     while(!test_vector.isDone()) {
@@ -60,6 +111,22 @@ int main(int argc, const char * argv[]) {
     gic_out << "GIC, GateToggle\n";
     simulator->dumpGIC(gic_out);
     gic_out.close();
+    if(delay_simulator != NULL) {
+        if(args.isOutputActivity()) {
+            std::string cap_col(args.isCapacitance() ? ", SwitchedCap" : "");
+            std::fstream act_out(args.getCircuitName() + std::string("_act.csv"), std::fstream::out);
+            act_out << "GateId, Transitions, Glitches" << cap_col << "\n";
+            delay_simulator->dumpActivity(act_out);
+            act_out.close();
+            std::fstream cycle_act_out(args.getCircuitName() + std::string("_cycle_act.csv"), std::fstream::out);
+            cycle_act_out << "Transitions" << cap_col << "\n";
+            delay_simulator->dumpCycleActivity(cycle_act_out);
+            cycle_act_out.close();
+        }
+        if(args.isPower()) {
+            std::cerr << "POWER: " << delay_simulator->estimatePower(args.getVdd(), args.getFreq()) << std::endl;
+        }
+    }
     //std::cout << "DONE" << std::endl;
     delete circuit;
     delete simulator;